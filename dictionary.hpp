@@ -0,0 +1,360 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "puzzle.hpp"
+#include "linereader.hpp"
+
+// On-disk layout of a compiled dictionary index, as written by
+// spbee-index: an indexHeader, then the parallel arrays of the
+// dictionary class (nWords masks, offsets, lengths and flags, in that
+// order), then blobSize bytes holding all the words back to back.
+// Integers are stored in the native byte order of the machine that
+// wrote the file.
+const char indexMagic[8] = {'S', 'P', 'B', 'E', 'E', 'I', 'D', 'X'};
+const std::uint32_t indexVersion = 2;
+
+struct indexHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t nWords;
+  std::uint64_t blobSize;
+};
+
+// Bits of a word's flags
+enum : std::uint8_t {
+  // the word consists of exactly 7 distinct letters (and nothing else)
+  pangramCapable = 1,
+};
+
+// A word list, with each word's letter set precomputed.  It is either
+// read from a plain text file (one word per line), or mapped directly
+// from a compiled index without any parsing.
+//
+// The words are kept as parallel arrays: the letter set, length, offset
+// and flags of word i are element i of each.  All the words' bytes live
+// in one block, either a single arena holding the text file, or the
+// mapping of the index, so loading makes a fixed number of allocations
+// however many words there are.
+class dictionary {
+public:
+  dictionary() = default;
+  dictionary(const dictionary &) = delete;
+  dictionary& operator=(const dictionary &) = delete;
+
+  ~dictionary() {
+    unmap();
+  }
+
+  // Load the file at 'path', detecting whether it is a compiled
+  // index or a text word list.  Returns false if it can't be read.
+  bool load(const std::string &path) {
+    unmap();
+
+    char magic[sizeof(indexMagic)] = {};
+    std::ifstream file(path, std::ios::binary);
+    if (! file.good() )
+      return false;
+    file.read(magic, sizeof(magic));
+
+    const bool isIndex = file.gcount() == sizeof(magic) &&
+      0 == std::memcmp(magic, indexMagic, sizeof(magic));
+    file.close();
+
+    return isIndex ? loadIndex(path) : loadText(path);
+  }
+
+  // Write the words out as a compiled index
+  bool save(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (! file.good() )
+      return false;
+
+    // The words are written back to back, without any line endings
+    std::vector<std::uint32_t> packedOffsets(nWords);
+    std::uint64_t packedSize = 0;
+    for (std::size_t i = 0; i < nWords; i++) {
+      packedOffsets[i] = packedSize;
+      packedSize += wordLengths[i];
+    }
+
+    if (packedSize > UINT32_MAX)
+      return false;
+
+    indexHeader header;
+    std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.nWords = nWords;
+    header.blobSize = packedSize;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(wordMasks),
+               nWords * sizeof(*wordMasks));
+    file.write(reinterpret_cast<const char*>(packedOffsets.data()),
+               nWords * sizeof(*wordOffsets));
+    file.write(reinterpret_cast<const char*>(wordLengths),
+               nWords * sizeof(*wordLengths));
+    file.write(reinterpret_cast<const char*>(wordFlags),
+               nWords * sizeof(*wordFlags));
+    for (std::size_t i = 0; i < nWords; i++)
+      file.write(blob + wordOffsets[i], wordLengths[i]);
+
+    return file.good();
+  }
+
+  std::size_t size() const {
+    return nWords;
+  }
+
+  std::string_view word(std::size_t i) const {
+    return std::string_view(blob + wordOffsets[i], wordLengths[i]);
+  }
+
+  std::size_t length(std::size_t i) const {
+    return wordLengths[i];
+  }
+
+  letterMask mask(std::size_t i) const {
+    return wordMasks[i];
+  }
+
+  bool isPangramCapable(std::size_t i) const {
+    return wordFlags[i] & pangramCapable;
+  }
+
+  // The whole arrays, for loops that want to run over them directly
+  const letterMask* masks() const {
+    return wordMasks;
+  }
+
+  const std::uint16_t* lengths() const {
+    return wordLengths;
+  }
+
+  // The number of words shorter than n
+  std::size_t countShorter(std::size_t n) const {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < nWords; i++)
+      count += wordLengths[i] < n;
+    return count;
+  }
+
+private:
+  // The flags of a word with the letter set 'mask'
+  static std::uint8_t flagsFor(letterMask mask) {
+    return (7 == maskSize(mask) && !(mask & nonLetterBit))
+      ? pangramCapable : 0;
+  }
+
+  // Read the whole file into the arena
+  bool readFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    // For a regular file, one allocation of the right size; for
+    // anything else, grow as needed
+    struct stat st;
+    std::size_t capacity = 1 << 16;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+      capacity = st.st_size + 1;
+
+    arena.resize(capacity);
+    std::size_t used = 0;
+
+    while (true) {
+      if (used == arena.size())
+        arena.resize(2 * arena.size());
+
+      ssize_t n = read(fd, arena.data() + used, arena.size() - used);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0) {
+        close(fd);
+        return false;
+      }
+      if (n == 0)
+        break;
+      used += n;
+    }
+
+    close(fd);
+    arena.resize(used);
+    return true;
+  }
+
+  bool loadText(const std::string &path) {
+    if (!readFile(path))
+      return false;
+
+    // Offsets into the arena are 32 bits wide
+    if (arena.size() > UINT32_MAX)
+      return false;
+
+    const char *begin = arena.data();
+    const char *end = begin + arena.size();
+
+    // One pass to count the lines, so the arrays are allocated once,
+    // and one to fill them in; both split the lines just as lineReader
+    // does
+    std::string_view line;
+    std::size_t nLines = 0;
+    for (const char *p = begin; p && p < end; nLines++)
+      p = splitLine(p, end, line);
+
+    ownMasks.resize(nLines);
+    ownOffsets.resize(nLines);
+    ownLengths.resize(nLines);
+    ownFlags.resize(nLines);
+
+    std::size_t n = 0;
+    for (const char *p = begin; p && p < end; ) {
+      p = splitLine(p, end, line);
+
+      // Words too long to index can never be in a puzzle anyway
+      if (line.length() > UINT16_MAX)
+        continue;
+
+      const letterMask mask = toLetterMask(line);
+      ownMasks[n] = mask;
+      ownOffsets[n] = line.data() - begin;
+      ownLengths[n] = line.length();
+      ownFlags[n] = flagsFor(mask);
+      n++;
+    }
+
+    wordMasks = ownMasks.data();
+    wordOffsets = ownOffsets.data();
+    wordLengths = ownLengths.data();
+    wordFlags = ownFlags.data();
+    blob = arena.data();
+    nWords = n;
+
+    return true;
+  }
+
+  bool loadIndex(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || std::size_t(st.st_size) < sizeof(indexHeader)) {
+      close(fd);
+      return false;
+    }
+
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+      return false;
+
+    mapping = addr;
+    mappingSize = st.st_size;
+
+    // The arrays must exactly fill the file between the header and the
+    // blob.  nWords is 32 bits, so the arrays' size can't overflow, but
+    // blobSize is checked by subtraction in case it is absurdly large.
+    const indexHeader *header = static_cast<const indexHeader*>(mapping);
+    const std::size_t n = header->nWords;
+    const std::size_t arraysSize = n
+      * (sizeof(*wordMasks) + sizeof(*wordOffsets)
+         + sizeof(*wordLengths) + sizeof(*wordFlags));
+    if (header->version != indexVersion
+        || arraysSize > mappingSize - sizeof(indexHeader)
+        || header->blobSize != mappingSize - sizeof(indexHeader) - arraysSize) {
+      unmap();
+      return false;
+    }
+
+    const letterMask *masks = reinterpret_cast<const letterMask*>(header + 1);
+    const std::uint32_t *offsets =
+      reinterpret_cast<const std::uint32_t*>(masks + n);
+    const std::uint16_t *lengths =
+      reinterpret_cast<const std::uint16_t*>(offsets + n);
+    const std::uint8_t *flags =
+      reinterpret_cast<const std::uint8_t*>(lengths + n);
+
+    if (!aligned(masks) || !aligned(offsets) || !aligned(lengths)) {
+      unmap();
+      return false;
+    }
+
+    // Every word must lie within the blob, and its mask and flags must
+    // be the ones its letters give, so nothing downstream can be led
+    // astray (say, by mask bits that aren't letters)
+    const char *words = reinterpret_cast<const char*>(flags + n);
+    for (std::size_t i = 0; i < n; i++) {
+      if (std::uint64_t(offsets[i]) + lengths[i] > header->blobSize) {
+        unmap();
+        return false;
+      }
+
+      const letterMask mask =
+        toLetterMask(std::string_view(words + offsets[i], lengths[i]));
+      if (masks[i] != mask || flags[i] != flagsFor(mask)) {
+        unmap();
+        return false;
+      }
+    }
+
+    wordMasks = masks;
+    wordOffsets = offsets;
+    wordLengths = lengths;
+    wordFlags = flags;
+    blob = words;
+    nWords = n;
+
+    return true;
+  }
+
+  // Whether p is suitably aligned to read a T through
+  template <class T>
+  static bool aligned(const T *p) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignof(T) == 0;
+  }
+
+  void unmap() {
+    if (mapping)
+      munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+
+    wordMasks = nullptr;
+    wordOffsets = nullptr;
+    wordLengths = nullptr;
+    wordFlags = nullptr;
+    blob = nullptr;
+    nWords = 0;
+  }
+
+  // Views of the words, either into our own storage or into the mapping
+  const letterMask *wordMasks = nullptr;      // the set of letters in each word
+  const std::uint32_t *wordOffsets = nullptr; // where each word starts in blob
+  const std::uint16_t *wordLengths = nullptr; // length of each word in bytes
+  const std::uint8_t *wordFlags = nullptr;
+  const char *blob = nullptr;
+  std::size_t nWords = 0;
+
+  // Storage for words read from a text file
+  std::vector<char> arena;
+  std::vector<letterMask> ownMasks;
+  std::vector<std::uint32_t> ownOffsets;
+  std::vector<std::uint16_t> ownLengths;
+  std::vector<std::uint8_t> ownFlags;
+
+  // The compiled index, if that's what we loaded
+  void *mapping = nullptr;
+  std::size_t mappingSize = 0;
+};
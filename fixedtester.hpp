@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+
+#include "puzzle.hpp"
+
+// A puzzle tester for one shape of puzzle fixed at compile time: nLetters
+// letters, nRequired of them required, and a minimum word length of nmin.
+// It gives the same answers as the puzzleTester it is made from, but the
+// length scores come from a constexpr table and the pangram bonus is a
+// constant.  Use matches() to see whether a puzzleTester has the shape.
+template <unsigned int nLetters, unsigned int nRequired, unsigned int nmin>
+class fixedPuzzleTester {
+public:
+  // Words at least this long all score their length
+  static const std::size_t tableLength = 32;
+
+  static bool matches(const puzzleTester &tester) {
+    return maskSize(tester.getAllMask()) == nLetters
+      && maskSize(tester.getReqMask()) == nRequired
+      && tester.nmin == nmin;
+  }
+
+  explicit fixedPuzzleTester(const puzzleTester &tester) :
+    allMask(tester.getAllMask()), reqMask(tester.getReqMask()) {
+  }
+
+  bool pass(letterMask mask) const {
+    return (mask & reqMask) == reqMask && (mask & ~allMask) == 0;
+  }
+
+  bool all(letterMask mask) const {
+    return (mask & allMask) == allMask;
+  }
+
+  unsigned int score(std::size_t length, letterMask mask) const {
+    if (!pass(mask))
+      return 0;
+
+    unsigned int score = length < tableLength ? scoreTable[length] : length;
+
+    if (score && all(mask))
+      score += nLetters;
+
+    return score;
+  }
+
+  // The total score for a group of words made with the same nmin
+  unsigned int score(const wordGroup &group) const {
+    if (!pass(group.mask))
+      return 0;
+
+    return group.baseScore + (all(group.mask) ? group.nWords * nLetters : 0);
+  }
+
+private:
+  static constexpr std::array<unsigned int, tableLength> makeScoreTable() {
+    std::array<unsigned int, tableLength> table = {};
+    for (std::size_t length = nmin; length < tableLength; length++)
+      table[length] = (length == nmin) ? 1 : length;
+    return table;
+  }
+
+  // lengthScore() for each length below tableLength
+  static constexpr std::array<unsigned int, tableLength> scoreTable
+    = makeScoreTable();
+
+  letterMask allMask;
+  letterMask reqMask;
+};
+
+// The classic puzzle: 7 letters, 1 in the center, words of 4 or more
+typedef fixedPuzzleTester<7, 1, 4> standardPuzzleTester;
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Split the first line off the text [first, last).  'line' is set to it
+// without its line ending, which may be "\n" or "\r\n".  Returns where
+// the next line starts, or nullptr if there is no newline, in which case
+// 'line' is all the rest of the text (less any trailing '\r').
+const char* splitLine(const char *first, const char *last,
+                      std::string_view &line) {
+  const char *newline = static_cast<const char*>(
+    std::memchr(first, '\n', last - first));
+  const char *end = newline ? newline : last;
+
+  if (end != first && end[-1] == '\r')
+    end--;
+  line = std::string_view(first, end - first);
+
+  return newline ? newline + 1 : nullptr;
+}
+
+// Reads a file a large block at a time, and hands out its lines as
+// string_views pointing into the block, so there is no allocation or
+// copy per line.  Line endings may be "\n" or "\r\n", and the last line
+// doesn't need a newline at all.  Each line is only valid until the
+// next call to next().
+class lineReader {
+public:
+  static const std::size_t blockSize = 1 << 20;
+
+  explicit lineReader(const std::string &path) :
+    fd(open(path.c_str(), O_RDONLY)), ownsFd(true), buffer(blockSize) {
+  }
+
+  // Read from a descriptor that is already open, such as a socket or
+  // standard input, reading up to 'size' bytes at a time.  The
+  // descriptor is left open.  A read returns whatever has arrived, so
+  // each line is handed out as soon as its newline comes in.
+  explicit lineReader(int fd, std::size_t size = blockSize) :
+    fd(fd), ownsFd(false), buffer(size) {
+  }
+
+  lineReader(const lineReader &) = delete;
+  lineReader& operator=(const lineReader &) = delete;
+
+  ~lineReader() {
+    if (ownsFd && fd >= 0)
+      close(fd);
+  }
+
+  // Whether the file could be opened
+  bool good() const {
+    return fd >= 0;
+  }
+
+  // Refuse lines of 'length' bytes or more (not counting the line
+  // ending) by throwing std::length_error from next(), without reading
+  // any more of them than that (0, the default, means no limit)
+  void setMaxLength(std::size_t length) {
+    maxLength = length;
+  }
+
+  // Get the next line, without its line ending.  Returns false at the
+  // end of the file, and throws std::system_error if reading fails.
+  bool next(std::string_view &line) {
+    while (true) {
+      // The line so far, complete or not
+      const char *next = splitLine(buffer.data() + begin,
+                                   buffer.data() + end, line);
+      if (maxLength && line.size() >= maxLength)
+        throw std::length_error("line too long");
+
+      if (next) {
+        begin = next - buffer.data();
+        return true;
+      }
+
+      if (atEOF) {
+        if (begin == end)
+          return false;
+
+        // A last line without a newline
+        begin = end;
+        return true;
+      }
+
+      fill();
+    }
+  }
+
+private:
+  // Read another block, keeping the partial line we have so far
+  void fill() {
+    if (fd < 0) {
+      atEOF = true;
+      return;
+    }
+
+    // Move the partial line to the front, and make room if a single
+    // line is longer than the whole buffer
+    std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+    end -= begin;
+    begin = 0;
+    if (end == buffer.size())
+      buffer.resize(2 * buffer.size());
+
+    ssize_t n;
+    do {
+      n = read(fd, buffer.data() + end, buffer.size() - end);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0)
+      throw std::system_error(errno, std::generic_category(), "read");
+
+    if (n == 0)
+      atEOF = true;
+    else
+      end += n;
+  }
+
+  int fd;
+  bool ownsFd;
+  std::vector<char> buffer;
+  std::size_t begin = 0; // start of the data not yet handed out
+  std::size_t end = 0;   // end of the data read into the buffer
+  bool atEOF = false;
+  std::size_t maxLength = 0;
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+
+// Batch kernels for the scan: test a whole array of word masks and
+// lengths against one puzzle, and write out the indices of the words
+// that pass and are at least nmin long.  On x86 the AVX2 version tests
+// 8 words per instruction and the SSE2 version 4; the best one the CPU
+// supports is picked at run time, with a plain loop everywhere else.
+//
+// Each kernel writes at most n indices to 'out', starting from 'base',
+// and returns how many it wrote.
+typedef std::size_t (*maskKernel)(const letterMask *masks,
+                                  const std::uint16_t *lengths,
+                                  std::size_t n, letterMask all,
+                                  letterMask req, unsigned int nmin,
+                                  std::uint32_t base, std::uint32_t *out);
+
+std::size_t filterMasksScalar(const letterMask *masks,
+                              const std::uint16_t *lengths,
+                              std::size_t n, letterMask all, letterMask req,
+                              unsigned int nmin, std::uint32_t base,
+                              std::uint32_t *out) {
+  std::size_t nOut = 0;
+
+  for (std::size_t i = 0; i < n; i++) {
+    // Write unconditionally, and only keep the index if it matched
+    out[nOut] = base + i;
+    nOut += (masks[i] & req) == req && (masks[i] & ~all) == 0
+      && lengths[i] >= nmin;
+  }
+
+  return nOut;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The longest length too short for nmin, as a signed 32-bit bound for
+// the kernels' length compare.  Lengths are 16 bits, so anything above
+// that is as good as infinite, and must not wrap negative.
+inline int shortBound(unsigned int nmin) {
+  return int(std::min(nmin, 65536u)) - 1;
+}
+
+// Append base + the position of each set bit of 'bits' to out
+inline std::size_t emitBits(unsigned int bits, std::uint32_t base,
+                            std::uint32_t *out) {
+  std::size_t nOut = 0;
+  for (; bits; bits &= bits - 1)
+    out[nOut++] = base + __builtin_ctz(bits);
+  return nOut;
+}
+
+__attribute__((target("sse2")))
+std::size_t filterMasksSSE2(const letterMask *masks,
+                            const std::uint16_t *lengths,
+                            std::size_t n, letterMask all, letterMask req,
+                            unsigned int nmin, std::uint32_t base,
+                            std::uint32_t *out) {
+  const __m128i vReq = _mm_set1_epi32(req);
+  const __m128i vNotAll = _mm_set1_epi32(~all);
+  const __m128i vShort = _mm_set1_epi32(shortBound(nmin));
+  const __m128i zero = _mm_setzero_si128();
+  std::size_t nOut = 0;
+  std::size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i));
+    const __m128i len = _mm_unpacklo_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(lengths + i)), zero);
+
+    const __m128i ok = _mm_and_si128(
+      _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(m, vReq), vReq),
+                    _mm_cmpeq_epi32(_mm_and_si128(m, vNotAll), zero)),
+      _mm_cmpgt_epi32(len, vShort));
+
+    const unsigned int bits = _mm_movemask_ps(_mm_castsi128_ps(ok));
+    if (bits)
+      nOut += emitBits(bits, base + i, out + nOut);
+  }
+
+  return nOut + filterMasksScalar(masks + i, lengths + i, n - i, all, req,
+                                  nmin, base + i, out + nOut);
+}
+
+__attribute__((target("avx2")))
+std::size_t filterMasksAVX2(const letterMask *masks,
+                            const std::uint16_t *lengths,
+                            std::size_t n, letterMask all, letterMask req,
+                            unsigned int nmin, std::uint32_t base,
+                            std::uint32_t *out) {
+  const __m256i vReq = _mm256_set1_epi32(req);
+  const __m256i vNotAll = _mm256_set1_epi32(~all);
+  const __m256i vShort = _mm256_set1_epi32(shortBound(nmin));
+  const __m256i zero = _mm256_setzero_si256();
+  std::size_t nOut = 0;
+  std::size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    const __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+    const __m256i len = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(lengths + i)));
+
+    const __m256i ok = _mm256_and_si256(
+      _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(m, vReq), vReq),
+                       _mm256_cmpeq_epi32(_mm256_and_si256(m, vNotAll), zero)),
+      _mm256_cmpgt_epi32(len, vShort));
+
+    const unsigned int bits = _mm256_movemask_ps(_mm256_castsi256_ps(ok));
+    if (bits)
+      nOut += emitBits(bits, base + i, out + nOut);
+  }
+
+  return nOut + filterMasksScalar(masks + i, lengths + i, n - i, all, req,
+                                  nmin, base + i, out + nOut);
+}
+
+#endif
+
+// The name of the kernel this CPU will use
+const char* maskKernelName() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx2"))
+    return "avx2";
+  if (__builtin_cpu_supports("sse2"))
+    return "sse2";
+#endif
+  return "scalar";
+}
+
+// The best kernel for this CPU
+maskKernel bestMaskKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx2"))
+    return filterMasksAVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return filterMasksSSE2;
+#endif
+  return filterMasksScalar;
+}
+
+// Append the ids of the dictionary words that solve the puzzle (and
+// are at least tester.nmin long) to 'matches', in dictionary order
+void scanMasks(const dictionary &dictWords, const puzzleTester &tester,
+               std::vector<std::uint32_t> &matches) {
+  static const maskKernel kernel = bestMaskKernel();
+  const std::size_t blockSize = 4096;
+  std::uint32_t block[blockSize];
+
+  for (std::size_t begin = 0; begin < dictWords.size(); begin += blockSize) {
+    const std::size_t n = std::min(blockSize, dictWords.size() - begin);
+    const std::size_t nOut = kernel(dictWords.masks() + begin,
+                                    dictWords.lengths() + begin, n,
+                                    tester.getAllMask(), tester.getReqMask(),
+                                    tester.nmin, begin, block);
+    matches.insert(matches.end(), block, block + nOut);
+  }
+}
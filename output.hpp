@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+// Buffered writer for the tools' results.  Output collects in a large
+// buffer, which is only written out when it fills up, on flush(), and
+// when the writer is destroyed.  In line-buffered mode, meant for
+// interactive use, it is also written out at the end of every line.
+class outputWriter {
+public:
+  static const std::size_t bufferSize = 1 << 16;
+
+  explicit outputWriter(int fd = STDOUT_FILENO) : fd(fd) {
+    buffer.reserve(bufferSize);
+  }
+
+  outputWriter(const outputWriter &) = delete;
+  outputWriter& operator=(const outputWriter &) = delete;
+
+  ~outputWriter() {
+    flush();
+  }
+
+  void setLineBuffered(bool lineBuffered) {
+    this->lineBuffered = lineBuffered;
+  }
+
+  outputWriter& operator<<(std::string_view s) {
+    if (buffer.size() + s.size() > bufferSize)
+      flush();
+
+    buffer.insert(buffer.end(), s.begin(), s.end());
+
+    if (lineBuffered && std::memchr(s.data(), '\n', s.size()))
+      flush();
+
+    return *this;
+  }
+
+  outputWriter& operator<<(char c) {
+    return *this << std::string_view(&c, 1);
+  }
+
+  template <class T,
+            class = std::enable_if_t<std::is_integral<T>::value>>
+  outputWriter& operator<<(T n) {
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), n).ptr;
+    return *this << std::string_view(digits, end - digits);
+  }
+
+  // Write out everything buffered so far.  Returns false if a write
+  // has ever failed; what couldn't be written is dropped.
+  bool flush() {
+    const char *data = buffer.data();
+    std::size_t size = buffer.size();
+
+    while (size && !failed) {
+      ssize_t n = write(fd, data, size);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0) {
+        failed = true; // nowhere to put it; drop the rest
+        break;
+      }
+
+      data += n;
+      size -= n;
+    }
+
+    buffer.clear();
+    return !failed;
+  }
+
+  // Whether everything so far has been written out (or is still
+  // buffered)
+  bool good() const {
+    return !failed;
+  }
+
+private:
+  int fd;
+  bool lineBuffered = false;
+  bool failed = false;
+  std::vector<char> buffer;
+};
@@ -7,21 +7,38 @@
 #include "cxxopts.hpp"
 
 #include "puzzle.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "stats.hpp"
 
 int main(int argc, char* argv[]) {
+  runStats stats;
+
   try {
 
-    int nmin;
+    int nLetters;
+    std::string exclude;
     std::string dict;
-    std::ifstream dictFile;
+    dictionary dictWords;
+    outputWriter out;
 
     cxxopts::Options options(argv[0], "Filter for pangram words for Frank Longo's \"Spelling Bee\" puzzles");
     options
       .show_positional_help();
 
     options.add_options()
-      ("d,dict", "Dictionary file path", cxxopts::value<std::string>(dict)
+      ("d,dict", "Dictionary file path (text, or compiled by spbee-index)", cxxopts::value<std::string>(dict)
        ->default_value("/usr/share/dict/words"), "FILE")
+      ("k,letters", "Number of distinct letters in a pangram",
+       cxxopts::value<int>(nLetters)->default_value("7"), "N")
+      ("x,exclude", "Skip words containing any of these letters",
+       cxxopts::value<std::string>(exclude)->default_value(""), "LETTERS")
+      ("sets", "Write each pangram letter set once, instead of the words")
+      ("puzzles", "Write a puzzle for each pangram letter set and each"
+       " choice of center letter, instead of the words")
+      ("l,line-buffered", "Write out each line of output as soon as it is"
+       " ready (for interactive use)")
+      ("stats", "Report time spent and work done on stderr")
       ("help", "Print this help message")
       ;
 
@@ -32,31 +49,93 @@ int main(int argc, char* argv[]) {
       exit(0);
     }
 
-    // Open dictionary file
+    out.setLineBuffered(result.count("line-buffered"));
+
+    if (nLetters < 1 || nLetters > 26) {
+      std::cerr << "Need 1 <= letters <= 26" << std::endl;
+      exit(1);
+    }
 
-    dictFile.open(dict);
-    if (! dictFile.good() ) {
+    if (!validInput(exclude)) {
+      std::cerr << "Excluded letters must be letters, not '"
+                << exclude << "'" << std::endl;
+      exit(1);
+    }
+
+    const letterMask excludeMask = toLetterMask(exclude);
+    const bool wantSets = result.count("sets") || result.count("puzzles");
+
+    stats.phase("dictionary");
+
+    // Load dictionary file (text or compiled index)
+
+    if (! dictWords.load(dict) ) {
       std::cerr << "Can't read from dictionary file '"
                 << dict << "'" << std::endl;
       exit(1);
     };
 
-    // Go through the dictionary file in one pass
+    stats.phase(wantSets ? "filter" : "filter and output");
+
+    // Go through the dictionary in one pass
 
-    std::string line;
+    unsigned long nMatches = 0;
+    std::vector<letterMask> sets;
 
-    while (std::getline(dictFile, line)) {
-      std::string sortedDownLine = line;
-      // downcase, sort, and remove dups
-      downSortUniq(sortedDownLine);
+    for (std::size_t i = 0; i < dictWords.size(); i++) {
+      const letterMask mask = dictWords.mask(i);
+      if ((mask & (excludeMask | nonLetterBit))
+          || int(maskSize(mask)) != nLetters)
+        continue;
 
-      if (7 == sortedDownLine.length()) {
-        std::cout << line << ' ' << sortedDownLine << std::endl;
-      };
+      nMatches++;
+      if (wantSets)
+        sets.push_back(mask);
+      else
+        out << dictWords.word(i) << ' ' << maskLetters(mask) << '\n';
+    }
+
+    if (wantSets) {
+      stats.phase("dedupe");
+
+      std::sort(sets.begin(), sets.end());
+      sets.erase(std::unique(sets.begin(), sets.end()), sets.end());
+
+      // Write the sets in the order of their letters as strings
+      std::vector<std::string> letters;
+      letters.reserve(sets.size());
+      for (auto mask : sets)
+        letters.push_back(maskLetters(mask));
+      std::sort(letters.begin(), letters.end());
+
+      stats.phase("output");
+
+      for (auto& set : letters) {
+        if (!result.count("puzzles")) {
+          out << set << '\n';
+          continue;
+        }
+
+        for (std::size_t center = 0; center < set.length(); center++) {
+          std::string puzzle = set;
+          puzzle[center] = toupper(puzzle[center]);
+          out << puzzle << '\n';
+        }
+      }
+
+      stats.count("letter sets", sets.size());
     }
 
     // All done!
-    dictFile.close();
+
+    out.flush();
+
+    if (result.count("stats")) {
+      stats.count("words read", dictWords.size());
+      stats.count("predicate evaluations", dictWords.size());
+      stats.count("matches", nMatches);
+      stats.report(std::cerr);
+    }
 
   } catch (const cxxopts::OptionException& e) {
     std::cout << "error parsing options: " << e.what() << std::endl;
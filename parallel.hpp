@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// The number of threads to use when the user asks for 'requested'
+// (0 meaning one per hardware thread)
+unsigned int threadCount(int requested) {
+  if (requested > 0)
+    return requested;
+
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Split [0, n) into nThreads contiguous blocks, and call f(begin, end)
+// for each block on its own thread.  Returns once all are done.
+template <class F>
+void parallelFor(std::size_t n, unsigned int nThreads, F f) {
+  nThreads = std::max(1u, std::min<unsigned int>(nThreads, n));
+
+  if (nThreads == 1) {
+    f(std::size_t(0), n);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+
+  for (unsigned int t = 0; t < nThreads; t++) {
+    std::size_t begin = n * t / nThreads;
+    std::size_t end = n * (t + 1) / nThreads;
+    threads.emplace_back(f, begin, end);
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters for this process, read through Linux's
+// perf_event_open().  Threads started after the counters are opened are
+// counted too, once they have been joined.  Any event that the kernel
+// or CPU won't provide (or any event at all, elsewhere than Linux) is
+// just reported as unavailable.
+class perfCounters {
+public:
+  static const std::size_t nEvents = 5;
+
+  static const char* eventName(std::size_t e) {
+    static const char* names[nEvents] = {
+      "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses",
+    };
+    return names[e];
+  }
+
+  perfCounters() {
+    fds.fill(-1);
+
+#ifdef __linux__
+    const std::uint32_t types[nEvents] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+      PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE,
+    };
+    const std::uint64_t configs[nEvents] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_MISSES,
+      PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_MISSES,
+    };
+
+    for (std::size_t e = 0; e < nEvents; e++) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = types[e];
+      attr.config = configs[e];
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      fds[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+  }
+
+  perfCounters(const perfCounters &) = delete;
+  perfCounters& operator=(const perfCounters &) = delete;
+
+  ~perfCounters() {
+#ifdef __linux__
+    for (int fd : fds)
+      if (fd >= 0)
+        close(fd);
+#endif
+  }
+
+  bool available(std::size_t e) const {
+    return fds[e] >= 0;
+  }
+
+  bool anyAvailable() const {
+    for (std::size_t e = 0; e < nEvents; e++)
+      if (available(e))
+        return true;
+    return false;
+  }
+
+  // The current counts, scaled up for any time the kernel had to
+  // share the hardware counters with other events.  Unavailable events
+  // read as 0.
+  std::vector<std::uint64_t> read() const {
+    std::vector<std::uint64_t> counts(nEvents, 0);
+
+#ifdef __linux__
+    for (std::size_t e = 0; e < nEvents; e++) {
+      std::uint64_t values[3]; // value, time enabled, time running
+      if (fds[e] < 0 || ::read(fds[e], values, sizeof(values)) != sizeof(values))
+        continue;
+
+      counts[e] = values[0];
+      if (values[2] && values[2] < values[1])
+        counts[e] = double(values[0]) * values[1] / values[2];
+    }
+#endif
+
+    return counts;
+  }
+
+private:
+  std::array<int, nEvents> fds;
+};
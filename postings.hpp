@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+
+// An inverted index from each letter to the dictionary words that
+// contain it, both as a sorted list of word ids and as a bitmap with
+// one bit per word.  A puzzle's candidate words are the intersection of
+// its required letters' postings, and only those are checked against
+// the puzzle's letters with the dictionary's mask array.  For a puzzle
+// with many letters (and so too many subsets to look up), and
+// especially one with several required letters, that can be far fewer
+// words than the whole dictionary.
+//
+// When the rarest required letter's list is short, the intersection
+// walks that list and looks each word's other letters up in the mask
+// array; otherwise it ANDs the letters' bitmaps 64 words at a time.
+//
+// The lists are stored back to back in one array, each sorted by word
+// id; the list for letter c is [starts[c], starts[c+1]).  The bitmap for
+// letter c is nBlocks 64-bit words starting at bitmaps[c * nBlocks].
+class postingsIndex {
+public:
+  explicit postingsIndex(const dictionary &dictWords) : dictWords(dictWords) {
+    // Count each letter's words, to lay out the lists in one pass
+    std::vector<std::uint32_t> counts(26, 0);
+    const letterMask *masks = dictWords.masks();
+
+    for (std::size_t i = 0; i < dictWords.size(); i++) {
+      if (masks[i] & nonLetterBit)
+        continue;
+      for (letterMask m = masks[i]; m; m &= m - 1)
+        counts[__builtin_ctz(m)]++;
+    }
+
+    starts.assign(27, 0);
+    for (unsigned int c = 0; c < 26; c++)
+      starts[c + 1] = starts[c] + counts[c];
+
+    ids.resize(starts[26]);
+    std::vector<std::uint32_t> next(starts.begin(), starts.end() - 1);
+
+    nBlocks = (dictWords.size() + 63) / 64;
+    bitmaps.assign(26 * nBlocks, 0);
+
+    for (std::uint32_t i = 0; i < dictWords.size(); i++) {
+      if (masks[i] & nonLetterBit)
+        continue;
+      for (letterMask m = masks[i]; m; m &= m - 1) {
+        const unsigned int c = __builtin_ctz(m);
+        ids[next[c]++] = i;
+        bitmaps[c * nBlocks + i / 64] |= std::uint64_t(1) << (i % 64);
+      }
+    }
+  }
+
+  // The number of words containing the letter with bit 'letter'
+  std::size_t count(letterMask letter) const {
+    const unsigned int c = __builtin_ctz(letter);
+    return starts[c + 1] - starts[c];
+  }
+
+  // The required letter of the puzzle with the fewest words, or 0 if
+  // it has no required letters
+  letterMask rarest(const puzzleTester &tester) const {
+    letterMask best = 0;
+    for (letterMask m = tester.getReqMask(); m; m &= m - 1) {
+      const letterMask letter = m & -m;
+      if (!best || count(letter) < count(best))
+        best = letter;
+    }
+    return best;
+  }
+
+  // Append the ids of the words that solve the puzzle (and are at least
+  // tester.nmin long) to 'matches', in dictionary order.  The puzzle
+  // must have a required letter.  Returns the number of list entries
+  // or bitmap words looked at.
+  std::size_t solve(const puzzleTester &tester,
+                    std::vector<std::uint32_t> &matches) const {
+    const letterMask req = tester.getReqMask();
+    const letterMask notAll = ~tester.getAllMask();
+    const letterMask *masks = dictWords.masks();
+    const std::uint16_t *lengths = dictWords.lengths();
+
+    const unsigned int c = __builtin_ctz(rarest(tester));
+    const std::size_t nRequired = maskSize(req);
+
+    if (starts[c + 1] - starts[c] <= nRequired * nBlocks) {
+      // Walk the rarest letter's list
+      for (std::uint32_t k = starts[c]; k < starts[c + 1]; k++) {
+        const std::uint32_t i = ids[k];
+        if ((masks[i] & req) == req && !(masks[i] & notAll)
+            && lengths[i] >= tester.nmin)
+          matches.push_back(i);
+      }
+
+      return starts[c + 1] - starts[c];
+    }
+
+    // AND the required letters' bitmaps, rarest first
+    std::vector<const std::uint64_t*> required{&bitmaps[c * nBlocks]};
+    for (letterMask m = req & ~rarest(tester); m; m &= m - 1)
+      required.push_back(&bitmaps[__builtin_ctz(m) * nBlocks]);
+
+    for (std::size_t b = 0; b < nBlocks; b++) {
+      std::uint64_t bits = required[0][b];
+      for (std::size_t k = 1; bits && k < required.size(); k++)
+        bits &= required[k][b];
+
+      for (; bits; bits &= bits - 1) {
+        const std::uint32_t i = b * 64 + __builtin_ctzll(bits);
+        if (!(masks[i] & notAll) && lengths[i] >= tester.nmin)
+          matches.push_back(i);
+      }
+    }
+
+    return nRequired * nBlocks;
+  }
+
+  // The number of 64-bit words in each letter's bitmap
+  std::size_t blocks() const {
+    return nBlocks;
+  }
+
+private:
+  const dictionary &dictWords;
+
+  // Where each letter's list starts in ids, plus an end marker
+  std::vector<std::uint32_t> starts;
+
+  // The word ids of all the lists
+  std::vector<std::uint32_t> ids;
+
+  // The bitmaps of all the letters
+  std::size_t nBlocks;
+  std::vector<std::uint64_t> bitmaps;
+};
@@ -1,9 +1,61 @@
 #pragma once
 
+#include <cstdint>
+#include <string_view>
+
+// A set of letters, stored as a bitmask: bit i is set when the letter
+// ('a' + i) appears, in either case.  Any other character sets
+// nonLetterBit, which is never part of a puzzle, so words containing
+// such characters can never pass.
+typedef std::uint32_t letterMask;
+
+const letterMask nonLetterBit = letterMask(1) << 26;
+
+letterMask charMask(char c) {
+  if ('a' <= c && c <= 'z')
+    return letterMask(1) << (c - 'a');
+  if ('A' <= c && c <= 'Z')
+    return letterMask(1) << (c - 'A');
+  return nonLetterBit;
+}
+
+// The set of (downcased) characters appearing in s
+letterMask toLetterMask(std::string_view s) {
+  letterMask mask = 0;
+  for (char c : s)
+    mask |= charMask(c);
+  return mask;
+}
+
+// The number of distinct letters in a mask
+unsigned int maskSize(letterMask mask) {
+  return __builtin_popcount(mask & ~nonLetterBit);
+}
+
+// The letters in a mask, lowercase and in alphabetical order
+std::string maskLetters(letterMask mask) {
+  std::string letters;
+  for (char c = 'a'; c <= 'z'; c++)
+    if (mask & charMask(c))
+      letters.push_back(c);
+  return letters;
+}
+
+// A puzzle with the letters in 'all', in alphabetical order, and those
+// in 'req' capitalized as required
+std::string puzzleLetters(letterMask all, letterMask req) {
+  std::string letters;
+  for (char c = 'a'; c <= 'z'; c++) {
+    if (all & charMask(c))
+      letters.push_back((req & charMask(c)) ? c - 'a' + 'A' : c);
+  }
+  return letters;
+}
+
 // validate that string s is a valid pattern for the puzzle
 // It is only allowed to consist of [a-zA-Z]
-bool validInput(const std::string & s) {
-  return all_of(s.begin(), s.end(), isalpha);
+bool validInput(std::string_view s) {
+  return std::all_of(s.begin(), s.end(), isalpha);
 }
 
 void downSortUniq(std::string & s) {
@@ -28,6 +80,23 @@ void upSortUniq(std::string & s) {
           s.end());
 };
 
+// The score for a word of the given length, not counting any bonus
+// for using all the letters
+unsigned int lengthScore(std::size_t length, unsigned int nmin) {
+  if (length < nmin)
+    return 0;
+
+  return (nmin == length) ? 1 : length;
+}
+
+// All the words of a dictionary that have the same set of letters.
+// Every puzzle treats these words alike, so they can be scored at once.
+struct wordGroup {
+  letterMask mask;         // the letters shared by the words
+  unsigned int nWords;     // how many words there are
+  unsigned int baseScore;  // the sum of their lengthScore()s
+};
+
 class puzzleTester {
 public:
   puzzleTester(const std::string &input) :
@@ -42,50 +111,89 @@ public:
 
     // downcase, sort, and unique all the characters in reqLower
     downSortUniq(reqLower);
+
+    allMask = toLetterMask(allLower);
+    reqMask = toLetterMask(reqLower);
+    nLetters = maskSize(allMask);
+  }
+
+  // Test whether or not a word with the letter set 'mask' can be made
+  // out of the given puzzle.
+  bool pass(letterMask mask) const {
+    return (mask & reqMask) == reqMask && (mask & ~allMask) == 0;
   }
 
-  // Test whether or not a given word 'test' can be made out of the given puzzle.
-  // Assume the input 'test' has already been converted to lower case
-  // and sorted
-  bool pass(const std::string &test) const {
-    return std::includes(    test.begin(),     test.end(),
-                         reqLower.begin(), reqLower.end()) &&
-           std::includes(allLower.begin(), allLower.end(),
-                             test.begin(),     test.end());
+  // Same, for a word given as a string.  The input 'test' does not
+  // need to be downcased or sorted.
+  bool pass(std::string_view test) const {
+    return pass(toLetterMask(test));
   }
 
   unsigned int nmin = 4;
 
   // Compute the score for a word based on the NYT scoring rules
-  unsigned int score(const std::string &word) const {
-    if (word.length() < nmin)
-      return 0;
+  unsigned int score(std::string_view word) const {
+    return score(word.length(), toLetterMask(word));
+  }
 
-    std::string sortedDownWord = word;
-    // downcase, sort, and remove dups
-    downSortUniq(sortedDownWord);
+  // Same, for a word of the given length whose letter set has already
+  // been computed with toLetterMask()
+  unsigned int score(std::size_t length, letterMask mask) const {
+    if (length < nmin)
+      return 0;
 
-    if (!pass(sortedDownWord)) {
+    if (!pass(mask)) {
       return 0;
     };
 
-    unsigned int score = (nmin == word.length()) ? 1 : word.length();
+    unsigned int score = lengthScore(length, nmin);
 
-    if (all(sortedDownWord))
-      score += allLower.length();
+    if (all(mask))
+      score += nLetters;
+
+    return score;
+  }
+
+  // The total score for a group of words.  The group must have been
+  // made with the same nmin as this puzzle's.
+  unsigned int score(const wordGroup &group) const {
+    if (!pass(group.mask))
+      return 0;
+
+    unsigned int score = group.baseScore;
+
+    if (all(group.mask))
+      score += group.nWords * nLetters;
 
     return score;
   }
 
   // Same as score(), but also adds the word's score to a running total
-  unsigned int scoreAndAccumulate(const std::string &word) {
-    unsigned wordScore = score(word);
+  unsigned int scoreAndAccumulate(std::string_view word) {
+    return scoreAndAccumulate(word.length(), toLetterMask(word));
+  }
+
+  unsigned int scoreAndAccumulate(std::size_t length, letterMask mask) {
+    unsigned wordScore = score(length, mask);
 
     totalScore += wordScore;
 
     return wordScore;
   }
 
+  unsigned int scoreAndAccumulate(const wordGroup &group) {
+    unsigned groupScore = score(group);
+
+    totalScore += groupScore;
+
+    return groupScore;
+  }
+
+  // Add a score worked out some other way to the running total
+  void accumulate(unsigned int score) {
+    totalScore += score;
+  }
+
   unsigned int getTotalScore() const {
     return totalScore;
   }
@@ -93,16 +201,31 @@ public:
   const std::string& getInput() const {
     return input;
   }
-  
+
+  letterMask getAllMask() const {
+    return allMask;
+  }
+
+  letterMask getReqMask() const {
+    return reqMask;
+  }
+
   // Functor interface
-  bool operator()(const std::string &test) const {
+  bool operator()(letterMask mask) const {
+    return pass(mask);
+  }
+
+  bool operator()(std::string_view test) const {
     return pass(test);
   }
 
   // Test whether all letters appear in the word
-  bool all(const std::string &test) const {
-    return std::includes(    test.begin(),     test.end(),
-                         allLower.begin(), allLower.end());
+  bool all(letterMask mask) const {
+    return (mask & allMask) == allMask;
+  }
+
+  bool all(std::string_view test) const {
+    return all(toLetterMask(test));
   }
 
   void debug() const {
@@ -117,5 +240,9 @@ private:
   std::string allLower; // all the letters, lowercase, unique
   std::string reqLower; // all the required letters, lowercase, unique
 
+  letterMask allMask; // all the letters, as a mask
+  letterMask reqMask; // all the required letters, as a mask
+  unsigned int nLetters; // number of distinct letters in the puzzle
+
   unsigned int totalScore = 0;
 };
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "puzzle.hpp"
+
+// Bits of the result of testing a word against a puzzleSet: anyPass if
+// some puzzle passes the word, and anyPangram if the word uses all the
+// letters of some puzzle
+constexpr unsigned int anyPass = 1;
+constexpr unsigned int anyPangram = 2;
+
+// Kernels testing one word mask against arrays of puzzle masks, as for
+// puzzleTester::pass() and puzzleTester::all(), returning anyPass and
+// anyPangram bits.  n must be a multiple of 8.
+typedef unsigned int (*puzzleSetKernel)(const letterMask *allMasks,
+                                        const letterMask *reqMasks,
+                                        std::size_t n, letterMask mask);
+
+unsigned int testPuzzlesScalar(const letterMask *allMasks,
+                               const letterMask *reqMasks,
+                               std::size_t n, letterMask mask) {
+  bool pass = false, all = false;
+
+  for (std::size_t i = 0; i < n; i++) {
+    pass |= (mask & reqMasks[i]) == reqMasks[i] && (mask & ~allMasks[i]) == 0;
+    all |= (mask & allMasks[i]) == allMasks[i];
+  }
+
+  return (pass ? anyPass : 0) | (all ? anyPangram : 0);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse2")))
+unsigned int testPuzzlesSSE2(const letterMask *allMasks,
+                             const letterMask *reqMasks,
+                             std::size_t n, letterMask mask) {
+  const __m128i m = _mm_set1_epi32(mask);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i pass = zero, all = zero;
+
+  for (std::size_t i = 0; i < n; i += 4) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(allMasks + i));
+    const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(reqMasks + i));
+
+    pass = _mm_or_si128(pass, _mm_and_si128(
+                          _mm_cmpeq_epi32(_mm_and_si128(m, r), r),
+                          _mm_cmpeq_epi32(_mm_andnot_si128(a, m), zero)));
+    all = _mm_or_si128(all, _mm_cmpeq_epi32(_mm_and_si128(m, a), a));
+  }
+
+  return (_mm_movemask_epi8(pass) ? anyPass : 0)
+    | (_mm_movemask_epi8(all) ? anyPangram : 0);
+}
+
+__attribute__((target("avx2")))
+unsigned int testPuzzlesAVX2(const letterMask *allMasks,
+                             const letterMask *reqMasks,
+                             std::size_t n, letterMask mask) {
+  const __m256i m = _mm256_set1_epi32(mask);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i pass = zero, all = zero;
+
+  for (std::size_t i = 0; i < n; i += 8) {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(allMasks + i));
+    const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(reqMasks + i));
+
+    pass = _mm256_or_si256(pass, _mm256_and_si256(
+                             _mm256_cmpeq_epi32(_mm256_and_si256(m, r), r),
+                             _mm256_cmpeq_epi32(_mm256_andnot_si256(a, m), zero)));
+    all = _mm256_or_si256(all, _mm256_cmpeq_epi32(_mm256_and_si256(m, a), a));
+  }
+
+  return (_mm256_testz_si256(pass, pass) ? 0 : anyPass)
+    | (_mm256_testz_si256(all, all) ? 0 : anyPangram);
+}
+
+#endif
+
+// The best kernel for this CPU
+puzzleSetKernel bestPuzzleSetKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx2"))
+    return testPuzzlesAVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return testPuzzlesSSE2;
+#endif
+  return testPuzzlesScalar;
+}
+
+// Many puzzles at once, for testing each word against all of them.
+// Their letter and required letter masks are kept in two contiguous
+// arrays, padded to a multiple of 8 with puzzles that nothing passes
+// and no word has all the letters of, so the kernels need no tail loop.
+class puzzleSet {
+public:
+  explicit puzzleSet(const std::vector<puzzleTester> &testers) :
+    kernel(bestPuzzleSetKernel()) {
+    for (const auto& tester : testers) {
+      allMasks.push_back(tester.getAllMask());
+      reqMasks.push_back(tester.getReqMask());
+    }
+
+    // Bit 31 is never in a word's mask
+    while (allMasks.size() % 8) {
+      allMasks.push_back(~letterMask(0));
+      reqMasks.push_back(~letterMask(0));
+    }
+  }
+
+  // Test a word's letter set against every puzzle: anyPass if any of
+  // them passes it, and anyPangram if it has all the letters of any
+  // of them
+  unsigned int test(letterMask mask) const {
+    return kernel(allMasks.data(), reqMasks.data(), allMasks.size(), mask);
+  }
+
+private:
+  puzzleSetKernel kernel;
+  std::vector<letterMask> allMasks;
+  std::vector<letterMask> reqMasks;
+};
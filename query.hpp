@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "planner.hpp"
+
+// Split a line into its fields, separated by spaces or tabs
+std::vector<std::string_view> splitFields(std::string_view line) {
+  std::vector<std::string_view> fields;
+
+  std::size_t begin = 0;
+  while ((begin = line.find_first_not_of(" \t", begin)) != line.npos) {
+    std::size_t end = std::min(line.find_first_of(" \t", begin), line.size());
+    fields.push_back(line.substr(begin, end - begin));
+    begin = end;
+  }
+
+  return fields;
+}
+
+// A puzzle from its letter string and an nmin to override the default
+// (or "" to keep it).  Returns nothing if either is invalid.
+std::optional<puzzleTester> parsePuzzle(std::string_view letters,
+                                        std::string_view nmin,
+                                        unsigned int defaultNmin) {
+  if (letters.empty() || !validInput(letters))
+    return std::nullopt;
+
+  unsigned int n = defaultNmin;
+  if (!nmin.empty()) {
+    auto parsed = std::from_chars(nmin.data(), nmin.data() + nmin.size(), n);
+    if (parsed.ec != std::errc() || parsed.ptr != nmin.data() + nmin.size())
+      return std::nullopt;
+
+    // No word is longer than this
+    if (n > UINT16_MAX)
+      return std::nullopt;
+  }
+
+  std::optional<puzzleTester> tester(std::in_place, std::string(letters));
+  tester->nmin = n;
+  return tester;
+}
+
+// Answers questions about one puzzle at a time from a dictionary that
+// stays loaded, with all the planner's indexes built up front.  Nothing
+// changes after construction, so any number of threads can share one.
+class queryEngine {
+public:
+  explicit queryEngine(const dictionary &dictWords) :
+    dictWords(dictWords), planner(dictWords, 1) {
+    planner.buildIndexes();
+
+    // The first of any repeated words wins
+    ids.reserve(dictWords.size());
+    for (std::uint32_t i = 0; i < dictWords.size(); i++)
+      ids.emplace(dictWords.word(i), i);
+  }
+
+  // The ids of the words that solve the puzzle, in dictionary order,
+  // by the strategy the planner picks for it
+  std::vector<std::uint32_t> solve(const puzzleTester &tester) {
+    std::vector<std::uint32_t> matches;
+    planner.solve(tester, planner.choose(tester), matches);
+    return matches;
+  }
+
+  // Write the words that solve the puzzle one per line, as spbee does,
+  // with a '*' before those that use all its letters.  Returns the
+  // number of words.
+  std::size_t writeSolution(outputWriter &out, const puzzleTester &tester) {
+    const auto matches = solve(tester);
+
+    for (auto i : matches) {
+      out << (tester.all(dictWords.mask(i)) ? "* " : "  ")
+          << dictWords.word(i) << '\n';
+    }
+
+    return matches.size();
+  }
+
+  // Write the words that solve the puzzle with their scores, as
+  // spbee-scores does, and then the total score
+  void writeScores(outputWriter &out, const puzzleTester &tester) {
+    unsigned long total = 0;
+
+    for (auto i : solve(tester)) {
+      const unsigned int wordScore = tester.score(dictWords.length(i),
+                                                  dictWords.mask(i));
+      total += wordScore;
+
+      out << (tester.all(dictWords.mask(i)) ? "* " : "  ")
+          << dictWords.word(i) << " " << wordScore << '\n';
+    }
+
+    out << "Total score: " << total << '\n';
+  }
+
+  // Why the word is not an answer to the puzzle, or nullptr if it is
+  const char* reject(const puzzleTester &tester, std::string_view word) const {
+    auto found = ids.find(word);
+    if (found == ids.end())
+      return "not in dictionary";
+
+    const letterMask mask = dictWords.mask(found->second);
+    if (dictWords.length(found->second) < tester.nmin)
+      return "too short";
+    if (mask & ~tester.getAllMask())
+      return "uses other letters";
+    if (!tester.pass(mask))
+      return "missing required letters";
+
+    return nullptr;
+  }
+
+private:
+  const dictionary &dictWords;
+  queryPlanner planner;
+
+  // Each word's id
+  std::unordered_map<std::string_view, std::uint32_t> ids;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// What a puzzle scored, for ranking it against other puzzles
+struct puzzleResult {
+  std::size_t index;       // the puzzle's position in the input
+  unsigned int score;      // total score
+  unsigned int nWords;     // number of words that solve it
+  unsigned int nPangrams;  // number of those that use every letter
+};
+
+// The k best (or, with 'bottom', the k worst) puzzles offered to it,
+// kept in a bounded heap so ranking n puzzles takes O(n log k) time and
+// O(k) space.  Puzzles are ranked by score; with 'tieBreak', equal
+// scores are ranked by number of words, then number of pangrams.  Any
+// remaining ties go to the puzzle earlier in the input, so the result
+// doesn't depend on the order puzzles are offered in.
+class puzzleRanking {
+public:
+  puzzleRanking(std::size_t k, bool bottom, bool tieBreak) :
+    k(k), bottom(bottom), tieBreak(tieBreak) {
+  }
+
+  void offer(const puzzleResult &result) {
+    if (heap.size() < k) {
+      heap.push_back(result);
+      std::push_heap(heap.begin(), heap.end(), comparator());
+    } else if (k && before(result, heap.front())) {
+      // Replace the lowest ranked of the k
+      std::pop_heap(heap.begin(), heap.end(), comparator());
+      heap.back() = result;
+      std::push_heap(heap.begin(), heap.end(), comparator());
+    }
+  }
+
+  // Offer every puzzle kept by another ranking
+  void merge(const puzzleRanking &other) {
+    for (const auto& result : other.heap)
+      offer(result);
+  }
+
+  // The puzzles kept, highest ranked first
+  std::vector<puzzleResult> sorted() const {
+    std::vector<puzzleResult> results(heap);
+    std::sort(results.begin(), results.end(), comparator());
+    return results;
+  }
+
+private:
+  // Whether a ranks ahead of b
+  bool before(const puzzleResult &a, const puzzleResult &b) const {
+    if (a.score != b.score)
+      return bottom ? a.score < b.score : a.score > b.score;
+
+    if (tieBreak) {
+      if (a.nWords != b.nWords)
+        return bottom ? a.nWords < b.nWords : a.nWords > b.nWords;
+      if (a.nPangrams != b.nPangrams)
+        return bottom ? a.nPangrams < b.nPangrams : a.nPangrams > b.nPangrams;
+    }
+
+    return a.index < b.index;
+  }
+
+  // With this ordering, the front of the heap is the lowest ranked
+  struct order {
+    const puzzleRanking *ranking;
+
+    bool operator()(const puzzleResult &a, const puzzleResult &b) const {
+      return ranking->before(a, b);
+    }
+  };
+
+  order comparator() const {
+    return order{this};
+  }
+
+  std::size_t k;
+  bool bottom;
+  bool tieBreak;
+
+  std::vector<puzzleResult> heap;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "puzzle.hpp"
+
+// On-disk layout of a table of puzzle scores, as written by
+// spbee-multi-scores --table: a tableHeader, then nPuzzles tableEntrys.
+// Integers are stored in the native byte order of the machine that
+// wrote the file.
+const char tableMagic[8] = {'S', 'P', 'B', 'E', 'E', 'T', 'B', 'L'};
+const std::uint32_t tableVersion = 1;
+
+struct tableHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t nmin;      // the minimum word length the scores are for
+  std::uint64_t nPuzzles;
+};
+
+struct tableEntry {
+  letterMask allMask;      // the puzzle's letters
+  letterMask reqMask;      // its required letters
+  std::uint32_t score;     // its total score
+  std::uint32_t nWords;    // the number of words that solve it
+};
+
+// Write a new table
+bool saveScoreTable(const std::string &path, unsigned int nmin,
+                    const std::vector<tableEntry> &entries) {
+  std::ofstream file(path, std::ios::binary);
+  if (! file.good() )
+    return false;
+
+  tableHeader header;
+  std::memcpy(header.magic, tableMagic, sizeof(tableMagic));
+  header.version = tableVersion;
+  header.nmin = nmin;
+  header.nPuzzles = entries.size();
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(entries.data()),
+             entries.size() * sizeof(tableEntry));
+
+  return file.good();
+}
+
+// A table of puzzle scores, mapped from its file.  When opened for
+// writing, changes to the entries go straight back to the file.
+class scoreTable {
+public:
+  scoreTable() = default;
+  scoreTable(const scoreTable &) = delete;
+  scoreTable& operator=(const scoreTable &) = delete;
+
+  ~scoreTable() {
+    unmap();
+  }
+
+  // Map the table at 'path'.  Returns false if it can't be read, or
+  // isn't a score table.
+  bool open(const std::string &path, bool writable) {
+    unmap();
+
+    int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || std::size_t(st.st_size) < sizeof(tableHeader)) {
+      close(fd);
+      return false;
+    }
+
+    void *addr = mmap(nullptr, st.st_size,
+                      writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+      return false;
+
+    mapping = addr;
+    mappingSize = st.st_size;
+
+    // The entries must exactly fill the rest of the file.  Dividing
+    // rather than multiplying keeps an absurd nPuzzles from overflowing.
+    const tableHeader *header = static_cast<const tableHeader*>(mapping);
+    const std::size_t entriesSize = mappingSize - sizeof(tableHeader);
+    if (0 != std::memcmp(header->magic, tableMagic, sizeof(tableMagic))
+        || header->version != tableVersion
+        || entriesSize % sizeof(tableEntry) != 0
+        || header->nPuzzles != entriesSize / sizeof(tableEntry)) {
+      unmap();
+      return false;
+    }
+
+    return true;
+  }
+
+  // Write any changes out to the file
+  bool sync() {
+    return 0 == msync(mapping, mappingSize, MS_SYNC);
+  }
+
+  std::size_t size() const {
+    return header()->nPuzzles;
+  }
+
+  unsigned int nmin() const {
+    return header()->nmin;
+  }
+
+  tableEntry& operator[](std::size_t i) {
+    return entries()[i];
+  }
+
+  const tableEntry& operator[](std::size_t i) const {
+    return entries()[i];
+  }
+
+private:
+  const tableHeader* header() const {
+    return static_cast<const tableHeader*>(mapping);
+  }
+
+  tableEntry* entries() const {
+    return reinterpret_cast<tableEntry*>(
+      static_cast<char*>(mapping) + sizeof(tableHeader));
+  }
+
+  void unmap() {
+    if (mapping)
+      munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+  }
+
+  void *mapping = nullptr;
+  std::size_t mappingSize = 0;
+};
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <fstream>
+
+#include <cctype>
+#include <algorithm>
+
+#include "cxxopts.hpp"
+
+#include "puzzle.hpp"
+#include "linereader.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "wordgroups.hpp"
+#include "subsetsums.hpp"
+
+int main(int argc, char* argv[]) {
+  try {
+
+    int nmin;
+    std::string dict;
+    std::string puzPath;
+    dictionary dictWords;
+    outputWriter out;
+
+    // The letter sets to score, one puzzle per choice of required letter
+    std::vector<letterMask> puzzleSets;
+
+    cxxopts::Options options(argv[0], "Scores for Frank Longo's \"Spelling Bee\" puzzle, for every choice of letters and center at once");
+
+    options.add_options()
+      ("d,dict", "Dictionary file path (text, or compiled by spbee-index)", cxxopts::value<std::string>(dict)
+       ->default_value("./enable1.txt"), "FILE")
+      ("p,puzfile", "Puzzles file path, one set of letters per line"
+       " (default: every 7-letter set spelling a word in the dictionary)",
+       cxxopts::value<std::string>(puzPath), "FILE")
+      ("n,nmin", "Minimum word length", cxxopts::value<int>(nmin)
+       ->default_value("4"), "N")
+      ("l,line-buffered", "Write out each line of output as soon as it is"
+       " ready (for interactive use)")
+      ("help", "Print this help message")
+      ;
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help({"", "Group"}) << std::endl;
+      exit(0);
+    }
+
+    out.setLineBuffered(result.count("line-buffered"));
+
+    // Load dictionary file (text or compiled index)
+
+    if (! dictWords.load(dict) ) {
+      std::cerr << "Can't read from dictionary file '"
+                << dict << "'" << std::endl;
+      exit(1);
+    };
+
+    if (result.count("puzfile")) {
+      // Open puzzles file
+      lineReader puzFile(puzPath);
+      if (! puzFile.good() ) {
+        std::cerr << "Can't read from puzzles file '"
+                  << puzPath << "'" << std::endl;
+        exit(1);
+      };
+
+      // Go through the puzzles file
+      std::string_view puzLine;
+
+      while (puzFile.next(puzLine)) {
+        letterMask set = toLetterMask(puzLine);
+
+        if (!validInput(puzLine) || !set) {
+          std::cerr << "Ignoring invalid puzzle input: " << puzLine << std::endl;
+        } else if (maskSize(set) > subsetSumScorer::maxLetters) {
+          std::cerr << "Ignoring puzzle with too many letters: " << puzLine << std::endl;
+        } else {
+          puzzleSets.push_back(set);
+        }
+      }
+    } else {
+      // Every pangram in the dictionary gives a puzzle; list each set of
+      // letters once, in alphabetical order
+      std::vector<std::string> letterSets;
+
+      for (std::size_t i = 0; i < dictWords.size(); i++) {
+        if (dictWords.isPangramCapable(i))
+          letterSets.push_back(maskLetters(dictWords.mask(i)));
+      }
+
+      std::sort(letterSets.begin(), letterSets.end());
+      letterSets.erase(std::unique(letterSets.begin(), letterSets.end()),
+                       letterSets.end());
+
+      for (const auto& letters : letterSets)
+        puzzleSets.push_back(toLetterMask(letters));
+    }
+
+    // Score each set of letters with every choice of required letter
+
+    std::vector<wordGroup> groups = groupByMask(dictWords, nmin);
+    subsetSumScorer scorer(groups);
+    std::vector<unsigned int> scores;
+
+    for (auto set : puzzleSets) {
+      scorer.scoreCenters(set, scores);
+
+      std::string letters = maskLetters(set);
+      for (std::size_t j = 0; j < letters.size(); j++) {
+        std::string puzzle = letters;
+        puzzle[j] = toupper(puzzle[j]);
+
+        out << scores[j] << " " << puzzle << '\n';
+      }
+    }
+
+    out.flush();
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(1);
+  } catch (const std::system_error& e) {
+    std::cerr << "error reading input: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,446 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <map>
+
+#include <cctype>
+#include <algorithm>
+
+#include "cxxopts.hpp"
+
+#include "puzzle.hpp"
+#include "linereader.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "wordgroups.hpp"
+#include "subsets.hpp"
+#include "subsetsums.hpp"
+#include "trie.hpp"
+#include "postings.hpp"
+#include "maskkernel.hpp"
+#include "puzzleset.hpp"
+#include "fixedtester.hpp"
+
+// Keeps the compiler from optimizing away the work being timed
+volatile unsigned long benchSink;
+
+// Runs benchmarks and reports them as tab-separated lines:
+//   name  ns/op  words/sec  [baseline ns/op  ratio to baseline]
+class benchRunner {
+public:
+  benchRunner(outputWriter &out, double minSeconds) :
+    out(out), minSeconds(minSeconds) {
+  }
+
+  // Read the results of an earlier run to compare against
+  bool loadBaseline(const std::string &path) {
+    lineReader file(path);
+    if (! file.good() )
+      return false;
+
+    std::string_view line;
+    while (file.next(line)) {
+      if (line.empty() || line[0] == '#')
+        continue;
+
+      std::istringstream fields{std::string(line)};
+      std::string name;
+      double nsPerOp;
+      if (fields >> name >> nsPerOp)
+        baseline[name] = nsPerOp;
+    }
+
+    return true;
+  }
+
+  void header() {
+    out << "# benchmark\tns/op\twords/sec";
+    if (!baseline.empty())
+      out << "\tbaseline-ns/op\tratio";
+    out << '\n';
+  }
+
+  // Time round() repeatedly until at least minSeconds have gone by.
+  // Each call of round() performs nOps operations, touching nWords
+  // dictionary words.
+  template <class F>
+  void run(const std::string &name, double nOps, double nWords, F round) {
+    typedef std::chrono::steady_clock clock;
+
+    round(); // warm up
+
+    unsigned long nRounds = 0;
+    const auto start = clock::now();
+    double elapsed;
+    do {
+      round();
+      nRounds++;
+      elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < minSeconds);
+
+    const double nsPerOp = 1e9 * elapsed / (nRounds * nOps);
+    const double wordsPerSec = nRounds * nWords / elapsed;
+
+    out << name << '\t' << format(nsPerOp) << '\t' << format(wordsPerSec);
+
+    auto old = baseline.find(name);
+    if (old != baseline.end())
+      out << '\t' << format(old->second) << '\t' << format(nsPerOp / old->second);
+    else if (!baseline.empty())
+      out << "\t-\t-";
+
+    out << '\n';
+    out.flush();
+  }
+
+private:
+  static std::string format(double x) {
+    std::ostringstream s;
+    s.precision(4);
+    s << x;
+    return s.str();
+  }
+
+  outputWriter &out;
+  double minSeconds;
+  std::map<std::string, double> baseline;
+};
+
+int main(int argc, char* argv[]) {
+  try {
+
+    int nmin;
+    int nPuzzles;
+    double minSeconds;
+    std::string dict;
+    std::string puzPath;
+    std::string baselinePath;
+    dictionary dictWords;
+    outputWriter out;
+
+    std::vector<puzzleTester> puzzleTesters;
+
+    cxxopts::Options options(argv[0], "Benchmarks for the \"Spelling Bee\" puzzle engine");
+
+    options.add_options()
+      ("d,dict", "Dictionary file path (text, or compiled by spbee-index)", cxxopts::value<std::string>(dict)
+       ->default_value("/usr/share/dict/words"), "FILE")
+      ("p,puzfile", "Puzzles file path (default: the dictionary's"
+       " pangram letter sets, with the first letter required)",
+       cxxopts::value<std::string>(puzPath), "FILE")
+      ("P,puzzles", "Maximum number of puzzles to use",
+       cxxopts::value<int>(nPuzzles)->default_value("1000"), "N")
+      ("n,nmin", "Minimum word length", cxxopts::value<int>(nmin)
+       ->default_value("4"), "N")
+      ("t,time", "Minimum time to run each benchmark, in seconds",
+       cxxopts::value<double>(minSeconds)->default_value("0.2"), "SECONDS")
+      ("b,baseline", "Compare against the output of an earlier run",
+       cxxopts::value<std::string>(baselinePath), "FILE")
+      ("help", "Print this help message")
+      ;
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help({"", "Group"}) << std::endl;
+      exit(0);
+    }
+
+    benchRunner bench(out, minSeconds);
+
+    if (result.count("baseline") && !bench.loadBaseline(baselinePath)) {
+      std::cerr << "Can't read from baseline file '"
+                << baselinePath << "'" << std::endl;
+      exit(1);
+    }
+
+    // Load dictionary file (text or compiled index)
+
+    if (! dictWords.load(dict) ) {
+      std::cerr << "Can't read from dictionary file '"
+                << dict << "'" << std::endl;
+      exit(1);
+    };
+
+    // Find the puzzles
+
+    if (result.count("puzfile")) {
+      lineReader puzFile(puzPath);
+      if (! puzFile.good() ) {
+        std::cerr << "Can't read from puzzles file '"
+                  << puzPath << "'" << std::endl;
+        exit(1);
+      };
+
+      std::string_view puzLine;
+      while (puzFile.next(puzLine) && int(puzzleTesters.size()) < nPuzzles) {
+        if (validInput(puzLine))
+          puzzleTesters.push_back(puzzleTester(std::string(puzLine)));
+      }
+    } else {
+      std::vector<letterMask> sets;
+      for (std::size_t i = 0; i < dictWords.size(); i++) {
+        if (dictWords.isPangramCapable(i))
+          sets.push_back(dictWords.mask(i));
+      }
+
+      std::sort(sets.begin(), sets.end());
+      sets.erase(std::unique(sets.begin(), sets.end()), sets.end());
+
+      for (auto set : sets) {
+        if (int(puzzleTesters.size()) >= nPuzzles)
+          break;
+
+        std::string letters = maskLetters(set);
+        letters[0] = toupper(letters[0]);
+        puzzleTesters.push_back(puzzleTester(letters));
+      }
+    }
+
+    if (!dictWords.size() || puzzleTesters.empty()) {
+      std::cerr << "Need a dictionary with words, and at least one puzzle"
+                << std::endl;
+      exit(1);
+    }
+
+    for (auto& tester : puzzleTesters) {
+      tester.nmin = nmin;
+    }
+
+    const double nWords = dictWords.size();
+    const double nTesters = puzzleTesters.size();
+    const puzzleTester &tester = puzzleTesters[0];
+
+    // A copy of the words as strings, for the string-based API
+    std::vector<std::string> strings;
+    for (std::size_t i = 0; i < dictWords.size(); i++)
+      strings.emplace_back(dictWords.word(i));
+
+    bench.header();
+
+    // Loading
+
+    bench.run("load-dictionary", nWords, nWords, [&]() {
+        dictionary loaded;
+        loaded.load(dict);
+        benchSink = loaded.size();
+      });
+
+    // Per-word costs
+
+    bench.run("word-downSortUniq", nWords, nWords, [&]() {
+        unsigned long n = 0;
+        for (const auto& word : strings) {
+          std::string sorted = word;
+          downSortUniq(sorted);
+          n += sorted.length();
+        }
+        benchSink = n;
+      });
+
+    bench.run("word-toLetterMask", nWords, nWords, [&]() {
+        unsigned long n = 0;
+        for (const auto& word : strings)
+          n += toLetterMask(word);
+        benchSink = n;
+      });
+
+    bench.run("word-pass-string", nWords, nWords, [&]() {
+        unsigned long n = 0;
+        for (const auto& word : strings)
+          n += tester.pass(word);
+        benchSink = n;
+      });
+
+    bench.run("word-pass-mask", nWords, nWords, [&]() {
+        unsigned long n = 0;
+        for (std::size_t i = 0; i < dictWords.size(); i++)
+          n += tester.pass(dictWords.mask(i));
+        benchSink = n;
+      });
+
+    bench.run("word-score-string", nWords, nWords, [&]() {
+        unsigned long n = 0;
+        for (const auto& word : strings)
+          n += tester.score(word);
+        benchSink = n;
+      });
+
+    bench.run("word-score-mask", nWords, nWords, [&]() {
+        unsigned long n = 0;
+        for (std::size_t i = 0; i < dictWords.size(); i++)
+          n += tester.score(dictWords.length(i), dictWords.mask(i));
+        benchSink = n;
+      });
+
+    if (standardPuzzleTester::matches(tester)) {
+      const standardPuzzleTester fixed(tester);
+
+      bench.run("word-score-fixed", nWords, nWords, [&]() {
+          unsigned long n = 0;
+          for (std::size_t i = 0; i < dictWords.size(); i++)
+            n += fixed.score(dictWords.length(i), dictWords.mask(i));
+          benchSink = n;
+        });
+    }
+
+    // Per-puzzle solve latency
+
+    std::vector<std::uint32_t> matches;
+
+    bench.run("solve-scan", nTesters, nTesters * nWords, [&]() {
+        for (const auto& t : puzzleTesters) {
+          matches.clear();
+          for (std::uint32_t i = 0; i < dictWords.size(); i++) {
+            if (t.score(dictWords.length(i), dictWords.mask(i)))
+              matches.push_back(i);
+          }
+        }
+        benchSink = matches.size();
+      });
+
+    bench.run("solve-scan-kernel", nTesters, nTesters * nWords, [&]() {
+        for (const auto& t : puzzleTesters) {
+          matches.clear();
+          scanMasks(dictWords, t, matches);
+        }
+        benchSink = matches.size();
+      });
+
+    // Each batch kernel the CPU can run, on the whole dictionary at once
+
+    std::vector<std::pair<const char*, maskKernel>> kernels = {
+      {"kernel-scalar", filterMasksScalar},
+    };
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("sse2"))
+      kernels.emplace_back("kernel-sse2", filterMasksSSE2);
+    if (__builtin_cpu_supports("avx2"))
+      kernels.emplace_back("kernel-avx2", filterMasksAVX2);
+#endif
+
+    std::vector<std::uint32_t> kernelOut(dictWords.size());
+
+    for (const auto& kernel : kernels) {
+      bench.run(kernel.first, nTesters, nTesters * nWords, [&]() {
+          std::size_t n = 0;
+          for (const auto& t : puzzleTesters) {
+            n += kernel.second(dictWords.masks(), dictWords.lengths(),
+                               dictWords.size(), t.getAllMask(),
+                               t.getReqMask(), t.nmin, 0, kernelOut.data());
+          }
+          benchSink = n;
+        });
+    }
+
+    subsetIndex index(dictWords);
+
+    bench.run("solve-subsets", nTesters, nTesters * nWords, [&]() {
+        for (const auto& t : puzzleTesters) {
+          matches.clear();
+          index.solve(t, matches);
+        }
+        benchSink = matches.size();
+      });
+
+    bench.run("build-subsets", 1, nWords, [&]() {
+        subsetIndex built(dictWords);
+        matches.clear();
+        built.solve(tester, matches);
+        benchSink = matches.size();
+      });
+
+    postingsIndex postings(dictWords);
+
+    bench.run("solve-postings", nTesters, nTesters * nWords, [&]() {
+        for (const auto& t : puzzleTesters) {
+          matches.clear();
+          if (t.getReqMask())
+            postings.solve(t, matches);
+        }
+        benchSink = matches.size();
+      });
+
+    bench.run("build-postings", 1, nWords, [&]() {
+        postingsIndex built(dictWords);
+        matches.clear();
+        built.solve(tester, matches);
+        benchSink = matches.size();
+      });
+
+    wordTrie trie(dictWords);
+
+    bench.run("solve-trie", nTesters, nTesters * nWords, [&]() {
+        for (const auto& t : puzzleTesters) {
+          matches.clear();
+          trie.solve(t, matches);
+        }
+        benchSink = matches.size();
+      });
+
+    bench.run("build-trie", 1, nWords, [&]() {
+        wordTrie built(dictWords);
+        matches.clear();
+        built.solve(tester, matches);
+        benchSink = matches.size();
+      });
+
+    // Whole sweeps over all the puzzles, as in spbee-multi-scores
+
+    bench.run("sweep-words", nTesters, nTesters * nWords, [&]() {
+        unsigned long total = 0;
+        for (const auto& t : puzzleTesters) {
+          for (std::size_t i = 0; i < dictWords.size(); i++)
+            total += t.score(dictWords.length(i), dictWords.mask(i));
+        }
+        benchSink = total;
+      });
+
+    // Any-puzzle matching, as in spbee with many puzzles
+
+    const puzzleSet puzzles(puzzleTesters);
+
+    bench.run("sweep-puzzle-set", nTesters, nTesters * nWords, [&]() {
+        unsigned long n = 0;
+        for (std::size_t i = 0; i < dictWords.size(); i++)
+          n += puzzles.test(dictWords.mask(i));
+        benchSink = n;
+      });
+
+    bench.run("sweep-groups", nTesters, nTesters * nWords, [&]() {
+        std::vector<wordGroup> groups = groupByMask(dictWords, nmin);
+        unsigned long total = 0;
+        for (const auto& t : puzzleTesters) {
+          for (const auto& group : groups)
+            total += t.score(group);
+        }
+        benchSink = total;
+      });
+
+    bench.run("sweep-subset-sums", nTesters, nTesters * nWords, [&]() {
+        std::vector<wordGroup> groups = groupByMask(dictWords, nmin);
+        subsetSumScorer scorer(groups);
+        std::vector<unsigned int> scores;
+        unsigned long total = 0;
+        for (const auto& t : puzzleTesters) {
+          if (maskSize(t.getAllMask()) > subsetSumScorer::maxLetters)
+            continue;
+          scorer.scoreCenters(t.getAllMask(), scores);
+          total += scores[0];
+        }
+        benchSink = total;
+      });
+
+    out.flush();
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(1);
+  } catch (const std::system_error& e) {
+    std::cerr << "error reading input: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,238 @@
+#include <iostream>
+#include <fstream>
+
+#include <cctype>
+#include <algorithm>
+
+#include "cxxopts.hpp"
+
+#include "puzzle.hpp"
+#include "linereader.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "fixedtester.hpp"
+#include "parallel.hpp"
+
+// A distinct word of either dictionary, and how many times it appears
+// in each
+struct unionWord {
+  std::string_view word;
+  letterMask mask;
+  unsigned int nOld;
+  unsigned int nNew;
+};
+
+// The words of both dictionaries with the same letters, scored as one
+// wordGroup for each dictionary
+struct unionGroup {
+  wordGroup oldGroup;
+  wordGroup newGroup;
+};
+
+// A puzzle's score with each dictionary
+struct scorePair {
+  unsigned int oldScore;
+  unsigned int newScore;
+};
+
+// Add the words of a dictionary that could be in a puzzle to 'words'
+void addWords(const dictionary &dictWords, unsigned int nmin, bool isNew,
+              std::vector<unionWord> &words) {
+  for (std::size_t i = 0; i < dictWords.size(); i++) {
+    if (dictWords.length(i) < nmin || (dictWords.mask(i) & nonLetterBit))
+      continue;
+
+    words.push_back(unionWord{dictWords.word(i), dictWords.mask(i),
+                              isNew ? 0u : 1u, isNew ? 1u : 0u});
+  }
+}
+
+// Score a puzzle against both dictionaries in one pass over the groups
+template <class T>
+scorePair scoreBoth(const T &tester, const std::vector<unionGroup> &groups) {
+  scorePair scores{0, 0};
+
+  for (const auto& group : groups) {
+    scores.oldScore += tester.score(group.oldGroup);
+    scores.newScore += tester.score(group.newGroup);
+  }
+
+  return scores;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+
+    int nmin;
+    int nThreads;
+    std::string oldPath;
+    std::string newPath;
+    std::string puzPath;
+    dictionary oldDict;
+    dictionary newDict;
+    outputWriter out;
+
+    std::vector<puzzleTester> puzzleTesters;
+
+    cxxopts::Options options(argv[0], "Report the \"Spelling Bee\" puzzles whose scores change between two dictionaries, and the words responsible");
+
+    options.add_options()
+      ("a,old", "Old dictionary file path (text, or compiled by spbee-index)",
+       cxxopts::value<std::string>(oldPath), "FILE")
+      ("b,new", "New dictionary file path (text, or compiled by spbee-index)",
+       cxxopts::value<std::string>(newPath), "FILE")
+      ("p,puzfile", "Puzzles file path", cxxopts::value<std::string>(puzPath)
+       ->default_value("./enable-1-pangrams-without-s.txt"), "FILE")
+      ("n,nmin", "Minimum word length", cxxopts::value<int>(nmin)
+       ->default_value("4"), "N")
+      ("j,jobs", "Number of threads (0 for one per CPU)",
+       cxxopts::value<int>(nThreads)->default_value("1"), "N")
+      ("l,line-buffered", "Write out each line of output as soon as it is"
+       " ready (for interactive use)")
+      ("help", "Print this help message")
+      ;
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help({"", "Group"}) << std::endl;
+      exit(0);
+    }
+
+    if (!result.count("old") || !result.count("new")) {
+      std::cerr << "Need both an old (-a) and a new (-b) dictionary"
+                << std::endl;
+      exit(1);
+    }
+
+    out.setLineBuffered(result.count("line-buffered"));
+
+    // Open puzzles file
+    lineReader puzFile(puzPath);
+    if (! puzFile.good() ) {
+      std::cerr << "Can't read from puzzles file '"
+                << puzPath << "'" << std::endl;
+      exit(1);
+    };
+
+    // Go through the puzzles file
+    std::string_view puzLine;
+
+    while (puzFile.next(puzLine)) {
+      if (validInput(puzLine)) {
+        puzzleTesters.push_back(puzzleTester(std::string(puzLine)));
+        puzzleTesters.back().nmin = nmin;
+      } else {
+        std::cerr << "Ignoring invalid puzzle input: " << puzLine << std::endl;
+      }
+    }
+
+    // Load dictionary files (text or compiled index)
+
+    if (! oldDict.load(oldPath) ) {
+      std::cerr << "Can't read from dictionary file '"
+                << oldPath << "'" << std::endl;
+      exit(1);
+    };
+
+    if (! newDict.load(newPath) ) {
+      std::cerr << "Can't read from dictionary file '"
+                << newPath << "'" << std::endl;
+      exit(1);
+    };
+
+    // Merge the two dictionaries into one list of distinct words, each
+    // counted in both, sorted by letter set and then by word
+
+    std::vector<unionWord> words;
+    words.reserve(oldDict.size() + newDict.size());
+    addWords(oldDict, nmin, false, words);
+    addWords(newDict, nmin, true, words);
+
+    std::sort(words.begin(), words.end(),
+              [](const unionWord &a, const unionWord &b) {
+                return a.mask != b.mask ? a.mask < b.mask : a.word < b.word;
+              });
+
+    std::vector<unionWord> merged;
+    for (const auto& word : words) {
+      if (!merged.empty() && merged.back().word == word.word) {
+        merged.back().nOld += word.nOld;
+        merged.back().nNew += word.nNew;
+      } else {
+        merged.push_back(word);
+      }
+    }
+
+    // Group the words by letter set, and keep the ones whose counts
+    // differ, which are the only ones that can change a score
+
+    std::vector<unionGroup> groups;
+    std::vector<unionWord> changed;
+
+    for (const auto& word : merged) {
+      if (groups.empty() || groups.back().oldGroup.mask != word.mask)
+        groups.push_back(unionGroup{{word.mask, 0, 0}, {word.mask, 0, 0}});
+
+      const unsigned int wordScore = lengthScore(word.word.length(), nmin);
+      groups.back().oldGroup.nWords += word.nOld;
+      groups.back().oldGroup.baseScore += word.nOld * wordScore;
+      groups.back().newGroup.nWords += word.nNew;
+      groups.back().newGroup.baseScore += word.nNew * wordScore;
+
+      if (word.nOld != word.nNew)
+        changed.push_back(word);
+    }
+
+    // Score every puzzle with both dictionaries at once
+
+    std::vector<scorePair> scores(puzzleTesters.size());
+
+    parallelFor(puzzleTesters.size(), threadCount(nThreads),
+                [&](std::size_t begin, std::size_t end) {
+                  for (std::size_t i = begin; i < end; i++) {
+                    const auto& tester = puzzleTesters[i];
+
+                    scores[i] = standardPuzzleTester::matches(tester)
+                      ? scoreBoth(standardPuzzleTester(tester), groups)
+                      : scoreBoth(tester, groups);
+                  }
+                });
+
+    // Print each puzzle whose score changed, and the words that were
+    // added (+) or removed (-) in it, with their scores
+
+    for (std::size_t i = 0; i < puzzleTesters.size(); i++) {
+      if (scores[i].oldScore == scores[i].newScore)
+        continue;
+
+      const auto& tester = puzzleTesters[i];
+      out << scores[i].oldScore << " " << scores[i].newScore << " "
+          << tester.getInput() << '\n';
+
+      for (const auto& word : changed) {
+        if (!tester.pass(word.mask))
+          continue;
+
+        const char sign = word.nNew > word.nOld ? '+' : '-';
+        const unsigned int n = word.nNew > word.nOld
+          ? word.nNew - word.nOld : word.nOld - word.nNew;
+        for (unsigned int k = 0; k < n; k++) {
+          out << "  " << sign << word.word << " "
+              << tester.score(word.word.length(), word.mask) << '\n';
+        }
+      }
+    }
+
+    out.flush();
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(1);
+  } catch (const std::system_error& e) {
+    std::cerr << "error reading input: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <fstream>
+
+#include <cctype>
+#include <algorithm>
+
+#include "cxxopts.hpp"
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+
+// A small, fast generator whose output only depends on the seed, on
+// every platform (unlike the std:: distributions)
+class splitMix64 {
+public:
+  explicit splitMix64(std::uint64_t seed) : state(seed) {
+  }
+
+  std::uint64_t next() {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // A number in [0, n)
+  std::uint64_t below(std::uint64_t n) {
+    return next() % n;
+  }
+
+private:
+  std::uint64_t state;
+};
+
+// Draws indices 0, 1, ... with probability proportional to their weights
+class weightedChoice {
+public:
+  explicit weightedChoice(const std::vector<unsigned int> &weights) {
+    unsigned long total = 0;
+    for (auto w : weights)
+      cumulative.push_back(total += w);
+  }
+
+  std::size_t operator()(splitMix64 &rng) const {
+    auto r = rng.below(cumulative.back());
+    return std::upper_bound(cumulative.begin(), cumulative.end(), r)
+      - cumulative.begin();
+  }
+
+private:
+  std::vector<unsigned long> cumulative;
+};
+
+// Approximate letter frequencies (per 1000 letters) in a word list
+// like ENABLE, for 'a' through 'z'
+const std::vector<unsigned int> letterWeights = {
+  76, 19, 40, 33, 114, 14, 30, 23, 86, 2, 9, 53, 27,
+  69, 66, 29, 2, 71, 87, 67, 33, 10, 9, 3, 16, 4,
+};
+
+// Approximate number of words (in thousands) of each length, starting
+// from length 2, in a word list like ENABLE
+const std::vector<unsigned int> lengthWeights = {
+  1, 10, 39, 86, 152, 231, 284, 249, 203, 155, 114, 78,
+  51, 32, 19, 11, 6, 3, 2, 1, 1, 1, 1, 1,
+};
+const unsigned int shortestLength = 2;
+
+int main(int argc, char* argv[]) {
+  try {
+
+    long nWords;
+    long nPuzzles;
+    int nLetters;
+    int nRequired;
+    unsigned long seed;
+    std::string dict;
+    dictionary dictWords;
+    outputWriter out;
+
+    cxxopts::Options options(argv[0], "Generate synthetic dictionaries or puzzle files for load testing the \"Spelling Bee\" tools");
+
+    options.add_options()
+      ("w,words", "Write a dictionary with this many words",
+       cxxopts::value<long>(nWords), "N")
+      ("P,puzzles", "Write a puzzles file with this many puzzles",
+       cxxopts::value<long>(nPuzzles), "N")
+      ("d,dict", "Draw the puzzles' letter sets from the pangrams in"
+       " this dictionary (default: draw letters at random)",
+       cxxopts::value<std::string>(dict), "FILE")
+      ("k,letters", "Number of letters in each puzzle",
+       cxxopts::value<int>(nLetters)->default_value("7"), "N")
+      ("r,required", "Number of required letters in each puzzle",
+       cxxopts::value<int>(nRequired)->default_value("1"), "N")
+      ("s,seed", "Random seed; the same seed gives the same output",
+       cxxopts::value<unsigned long>(seed)->default_value("1"), "N")
+      ("help", "Print this help message")
+      ;
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help({"", "Group"}) << std::endl;
+      exit(0);
+    }
+
+    if (result.count("words") + result.count("puzzles") != 1) {
+      std::cerr << "Need exactly one of -w or -P" << std::endl;
+      exit(1);
+    }
+
+    splitMix64 rng(seed);
+    const weightedChoice letterChoice(letterWeights);
+
+    if (result.count("words")) {
+      // Letters are drawn independently, except that a letter already
+      // in the word is often repeated, as happens in real words
+      const weightedChoice lengthChoice(lengthWeights);
+      std::string word;
+
+      for (long n = 0; n < nWords; n++) {
+        const std::size_t length = shortestLength + lengthChoice(rng);
+        word.clear();
+
+        while (word.length() < length) {
+          if (!word.empty() && rng.below(10) < 3)
+            word.push_back(word[rng.below(word.length())]);
+          else
+            word.push_back('a' + letterChoice(rng));
+        }
+
+        out << word << '\n';
+      }
+
+      out.flush();
+      return 0;
+    }
+
+    if (nLetters < 1 || nLetters > 26 || nRequired < 0 || nRequired > nLetters) {
+      std::cerr << "Need 1 <= letters <= 26 and 0 <= required <= letters"
+                << std::endl;
+      exit(1);
+    }
+
+    // The letter sets to draw from, if we have a dictionary
+    std::vector<letterMask> sets;
+
+    if (result.count("dict")) {
+      if (! dictWords.load(dict) ) {
+        std::cerr << "Can't read from dictionary file '"
+                  << dict << "'" << std::endl;
+        exit(1);
+      };
+
+      for (std::size_t i = 0; i < dictWords.size(); i++) {
+        letterMask mask = dictWords.mask(i);
+        if (!(mask & nonLetterBit) && int(maskSize(mask)) == nLetters)
+          sets.push_back(mask);
+      }
+
+      std::sort(sets.begin(), sets.end());
+      sets.erase(std::unique(sets.begin(), sets.end()), sets.end());
+
+      if (sets.empty()) {
+        std::cerr << "No words in the dictionary have " << nLetters
+                  << " different letters" << std::endl;
+        exit(1);
+      }
+    }
+
+    for (long n = 0; n < nPuzzles; n++) {
+      std::string letters;
+
+      if (!sets.empty()) {
+        letters = maskLetters(sets[rng.below(sets.size())]);
+      } else {
+        letterMask mask = 0;
+        while (int(maskSize(mask)) < nLetters)
+          mask |= letterMask(1) << letterChoice(rng);
+        letters = maskLetters(mask);
+      }
+
+      // Capitalize nRequired of the letters
+      for (int r = 0; r < nRequired; r++) {
+        std::size_t j;
+        do {
+          j = rng.below(letters.length());
+        } while (isupper(letters[j]));
+        letters[j] = toupper(letters[j]);
+      }
+
+      out << letters << '\n';
+    }
+
+    out.flush();
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
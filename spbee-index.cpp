@@ -0,0 +1,62 @@
+#include <iostream>
+#include <fstream>
+
+#include <cctype>
+#include <algorithm>
+
+#include "cxxopts.hpp"
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+
+int main(int argc, char* argv[]) {
+  try {
+
+    std::string dict;
+    std::string outPath;
+    dictionary dictWords;
+
+    cxxopts::Options options(argv[0], "Compile a dictionary into a binary index for the \"Spelling Bee\" tools");
+
+    options.add_options()
+      ("d,dict", "Dictionary file path", cxxopts::value<std::string>(dict)
+       ->default_value("/usr/share/dict/words"), "FILE")
+      ("o,output", "Index file path", cxxopts::value<std::string>(outPath), "FILE")
+      ("help", "Print this help message")
+      ;
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help({"", "Group"}) << std::endl;
+      exit(0);
+    }
+
+    if (!result.count("output")) {
+      std::cerr << "Need an output file (-o)" << std::endl;
+      exit(1);
+    }
+
+    // Load dictionary file
+
+    if (! dictWords.load(dict) ) {
+      std::cerr << "Can't read from dictionary file '"
+                << dict << "'" << std::endl;
+      exit(1);
+    };
+
+    // Write it back out as an index
+
+    if (! dictWords.save(outPath) ) {
+      std::cerr << "Can't write to index file '"
+                << outPath << "'" << std::endl;
+      exit(1);
+    };
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
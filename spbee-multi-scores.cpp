@@ -3,31 +3,83 @@
 
 #include <cctype>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
 
 #include "cxxopts.hpp"
 
 #include "puzzle.hpp"
+#include "linereader.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "stats.hpp"
+#include "wordgroups.hpp"
+#include "fixedtester.hpp"
+#include "parallel.hpp"
+#include "ranking.hpp"
+#include "scoretable.hpp"
+
+// Score a puzzle against every word group, using whichever kind of
+// tester fits it, and count the words and pangrams that matched
+template <class T>
+puzzleResult scoreGroups(const T &tester, const std::vector<wordGroup> &groups) {
+  puzzleResult result{0, 0, 0, 0};
+
+  for (const auto& group : groups) {
+    unsigned int groupScore = tester.score(group);
+    if (groupScore) {
+      result.score += groupScore;
+      result.nWords += group.nWords;
+      if (tester.all(group.mask))
+        result.nPangrams += group.nWords;
+    }
+  }
+
+  return result;
+}
 
 int main(int argc, char* argv[]) {
+  runStats stats;
+
   try {
 
     int nmin;
+    int nThreads;
+    std::size_t nRanked = 0;
     std::string dict;
     std::string puzPath;
-    std::ifstream dictFile;
-    std::ifstream puzFile;
+    std::string tablePath;
+    dictionary dictWords;
+    outputWriter out;
 
     std::vector<puzzleTester> puzzleTesters;
 
     cxxopts::Options options(argv[0], "Solver for Frank Longo's \"Spelling Bee\" puzzle, with scoring for many puzzles");
 
     options.add_options()
-      ("d,dict", "Dictionary file path", cxxopts::value<std::string>(dict)
+      ("d,dict", "Dictionary file path (text, or compiled by spbee-index)", cxxopts::value<std::string>(dict)
        ->default_value("./enable1.txt"), "FILE")
       ("p,puzfile", "Puzzles file path", cxxopts::value<std::string>(puzPath)
        ->default_value("./enable-1-pangrams-without-s.txt"), "FILE")
       ("n,nmin", "Minimum word length", cxxopts::value<int>(nmin)
        ->default_value("4"), "N")
+      ("j,jobs", "Number of threads (0 for one per CPU)",
+       cxxopts::value<int>(nThreads)->default_value("1"), "N")
+      ("top", "Print only the K highest scoring puzzles, best first",
+       cxxopts::value<std::size_t>(nRanked), "K")
+      ("bottom", "Print only the K lowest scoring puzzles, worst first",
+       cxxopts::value<std::size_t>(nRanked), "K")
+      ("tie-break", "With --top or --bottom, rank puzzles with equal"
+       " scores by number of words, then number of pangrams")
+      ("table", "Also save every puzzle's score to this file, for"
+       " spbee-table", cxxopts::value<std::string>(tablePath), "FILE")
+      ("l,line-buffered", "Write out each line of output as soon as it is"
+       " ready (for interactive use)")
+      ("stats", "Report time spent and work done on stderr")
+      ("perf", "Report what --stats does, plus hardware performance"
+       " counters (cycles, instructions, branch and cache misses) for each"
+       " phase")
       ("help", "Print this help message")
       ;
 
@@ -38,63 +90,161 @@ int main(int argc, char* argv[]) {
       exit(0);
     }
 
+    out.setLineBuffered(result.count("line-buffered"));
+
+    if (result.count("top") && result.count("bottom")) {
+      std::cerr << "Can't use both --top and --bottom" << std::endl;
+      exit(1);
+    }
+
+    const bool ranked = result.count("top") || result.count("bottom");
+    const bool bottom = result.count("bottom");
+    const bool tieBreak = result.count("tie-break");
+    std::optional<puzzleRanking> ranking;
+    std::mutex rankingMutex;
+
+    if (ranked)
+      ranking.emplace(nRanked, bottom, tieBreak);
+
+    if (result.count("perf"))
+      stats.enablePerf();
+
+    stats.phase("puzzles");
+
     // Open puzzles file
-    puzFile.open(puzPath);
+    lineReader puzFile(puzPath);
     if (! puzFile.good() ) {
       std::cerr << "Can't read from puzzles file '"
-                << dict << "'" << std::endl;
+                << puzPath << "'" << std::endl;
       exit(1);
     };
 
     // Go through the puzzles file
-    std::string puzLine;
+    std::string_view puzLine;
 
-    while (std::getline(puzFile, puzLine)) {
+    while (puzFile.next(puzLine)) {
       if (validInput(puzLine)) {
-        puzzleTesters.push_back(puzzleTester(puzLine));
+        puzzleTesters.push_back(puzzleTester(std::string(puzLine)));
       } else {
         std::cerr << "Ignoring invalid puzzle input: " << puzLine << std::endl;
       }
     }
 
-    // All done with puzzles file
-    puzFile.close();
-
     // set all the nmin's
     for (auto& tester : puzzleTesters) {
       tester.nmin = nmin;
     }
 
-    // Open dictionary file
+    stats.phase("dictionary");
+
+    // Load dictionary file (text or compiled index)
 
-    dictFile.open(dict);
-    if (! dictFile.good() ) {
+    if (! dictWords.load(dict) ) {
       std::cerr << "Can't read from dictionary file '"
                 << dict << "'" << std::endl;
       exit(1);
     };
 
-    // Go through the dictionary file in one pass
+    // Words with the same letters score the same in every puzzle, so
+    // collapse the dictionary down to its distinct letter sets
+
+    stats.phase("group");
+
+    std::vector<wordGroup> groups = groupByMask(dictWords, nmin);
+
+    stats.phase("score");
+
+    // Score every puzzle against every group.  Each thread gets its own
+    // block of puzzles, so every running total is only touched by one
+    // thread, and the results don't depend on the number of threads.
+    // Standard puzzles get a tester specialized for their shape.  When
+    // ranking, each thread keeps its own best K, merged in at the end.
+
+    std::atomic<unsigned long> nMatches(0);
+
+    const bool saveTable = result.count("table");
+    std::vector<tableEntry> table(saveTable ? puzzleTesters.size() : 0);
 
-    std::string line;
+    parallelFor(puzzleTesters.size(), threadCount(nThreads),
+                [&](std::size_t begin, std::size_t end) {
+                  unsigned long n = 0;
+                  std::optional<puzzleRanking> blockRanking;
+                  if (ranked)
+                    blockRanking.emplace(nRanked, bottom, tieBreak);
 
-    while (std::getline(dictFile, line)) {
+                  for (std::size_t i = begin; i < end; i++) {
+                    auto& tester = puzzleTesters[i];
+
+                    puzzleResult puzzle =
+                      standardPuzzleTester::matches(tester)
+                      ? scoreGroups(standardPuzzleTester(tester), groups)
+                      : scoreGroups(tester, groups);
+
+                    puzzle.index = i;
+                    tester.accumulate(puzzle.score);
+                    n += puzzle.nWords;
+
+                    if (ranked)
+                      blockRanking->offer(puzzle);
+
+                    if (saveTable) {
+                      table[i] = tableEntry{tester.getAllMask(),
+                                            tester.getReqMask(),
+                                            puzzle.score, puzzle.nWords};
+                    }
+                  }
+
+                  nMatches += n;
+
+                  if (ranked) {
+                    std::lock_guard<std::mutex> lock(rankingMutex);
+                    ranking->merge(*blockRanking);
+                  }
+                });
+
+    // All done!
+
+    stats.phase("output");
+
+    // Print results
+    if (ranked) {
+      for (const auto& puzzle : ranking->sorted()) {
+        out << puzzle.score << " "
+            << puzzleTesters[puzzle.index].getInput() << '\n';
+      }
+    } else {
       for (auto& tester : puzzleTesters) {
-        tester.scoreAndAccumulate(line);
+        out << tester.getTotalScore() << " " << tester.getInput() << '\n';
       }
     }
 
-    // All done!
-    dictFile.close();
+    out.flush();
 
-    // Print results
-    for (auto& tester : puzzleTesters) {
-      std::cout << tester.getTotalScore() << " " << tester.getInput() << std::endl;
+    if (saveTable) {
+      stats.phase("table");
+
+      if (! saveScoreTable(tablePath, nmin, table) ) {
+        std::cerr << "Can't write to table file '"
+                  << tablePath << "'" << std::endl;
+        exit(1);
+      }
+    }
+
+    if (result.count("stats") || result.count("perf")) {
+      stats.count("words read", dictWords.size());
+      stats.count("words rejected by nmin", dictWords.countShorter(nmin));
+      stats.count("word groups", groups.size());
+      stats.count("predicate evaluations", puzzleTesters.size() * groups.size());
+      stats.count("matches", nMatches);
+      stats.report(std::cerr, "score");
     }
-    
+
   } catch (const cxxopts::OptionException& e) {
     std::cout << "error parsing options: " << e.what() << std::endl;
     exit(1);
+  } catch (const std::system_error& e) {
+    std::cerr << "error reading input: " << e.what() << std::endl;
+    exit(1);
   }
 
   return 0;
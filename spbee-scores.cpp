@@ -7,13 +7,24 @@
 #include "cxxopts.hpp"
 
 #include "puzzle.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "stats.hpp"
+#include "subsets.hpp"
+#include "trie.hpp"
+#include "planner.hpp"
+#include "maskkernel.hpp"
 
 int main(int argc, char* argv[]) {
+  runStats stats;
+
   try {
 
     int nmin;
     std::string dict;
-    std::ifstream dictFile;
+    std::string solver;
+    dictionary dictWords;
+    outputWriter out;
     std::vector<std::string> words;
 
     cxxopts::Options options(argv[0], "Solver for Frank Longo's \"Spelling Bee\" puzzle, with scoring");
@@ -22,11 +33,21 @@ int main(int argc, char* argv[]) {
       .show_positional_help();
 
     options.add_options()
-      ("d,dict", "Dictionary file path", cxxopts::value<std::string>(dict)
+      ("d,dict", "Dictionary file path (text, or compiled by spbee-index)", cxxopts::value<std::string>(dict)
        ->default_value("/usr/share/dict/words"), "FILE")
       ("n,nmin", "Minimum word length", cxxopts::value<int>(nmin)
        ->default_value("4"), "N")
       ("t,total", "Report total score")
+      ("s,solver", "Solving strategy: 'scan' the whole dictionary,"
+       " look up the 'subsets' of the puzzle letters, walk a"
+       " 'trie' of the words along the puzzle letters, or let the"
+       " planner pick for each puzzle ('auto')",
+       cxxopts::value<std::string>(solver)->default_value("scan"), "NAME")
+      ("v,verbose", "With --solver auto, report the strategy chosen for"
+       " each puzzle, and its estimated cost, on stderr")
+      ("l,line-buffered", "Write out each line of output as soon as it is"
+       " ready (for interactive use)")
+      ("stats", "Report time spent and work done on stderr")
       ("help", "Print this help message")
       ("positional",
        "puzzle letter string: Give a string"
@@ -45,11 +66,15 @@ int main(int argc, char* argv[]) {
       exit(0);
     }
 
+    out.setLineBuffered(result.count("line-buffered"));
+
     if (1 != result.count("positional")) { // no input, nothing to do.
       std::cout << "Need exactly 1 puzzle string" << std::endl;
       exit(0);
     }
 
+    stats.phase("puzzles");
+
     if (! validInput(words[0])) {
       std::cerr << "Invalid input: " << words[0] << std::endl;
       exit(0);
@@ -58,44 +83,93 @@ int main(int argc, char* argv[]) {
     puzzleTester tester(words[0]);
     tester.nmin = nmin;
     
-    // Open dictionary file
+    if (solver != "scan" && solver != "subsets" && solver != "trie"
+        && solver != "auto") {
+      std::cerr << "Unknown solver: " << solver << std::endl;
+      exit(1);
+    }
+
+    stats.phase("dictionary");
 
-    dictFile.open(dict);
-    if (! dictFile.good() ) {
+    // Load dictionary file (text or compiled index)
+
+    if (! dictWords.load(dict) ) {
       std::cerr << "Can't read from dictionary file '"
                 << dict << "'" << std::endl;
       exit(1);
     };
 
-    // Go through the dictionary file in one pass
+    // Find the ids of all the words that solve the puzzle
 
-    std::string line;
+    std::vector<std::uint32_t> matches;
+    unsigned long nEvaluations = 0;
 
-    while (std::getline(dictFile, line)) {
-      unsigned long wordScore = tester.scoreAndAccumulate(line);
+    queryPlanner planner(dictWords, 1);
+    solveStrategy strategy = solveStrategy::scan;
 
-      if (wordScore == 0)
-        continue;
+    if (solver == "auto") {
+      strategy = planner.choose(tester);
+      if (result.count("verbose"))
+        planner.explain(std::cerr, tester);
+    }
 
-      std::string sortedDownLine = line;
-      // downcase, sort, and remove dups
-      downSortUniq(sortedDownLine);
+    if (strategy != solveStrategy::scan) {
+      // Any index is built as part of solving
+      stats.phase("solve");
+      nEvaluations = planner.solve(tester, strategy, matches);
+    } else if (solver == "subsets") {
+      stats.phase("index");
+      subsetIndex index(dictWords);
+
+      stats.phase("solve");
+      nEvaluations = index.solve(tester, matches);
+    } else if (solver == "trie") {
+      stats.phase("index");
+      wordTrie trie(dictWords);
+
+      stats.phase("solve");
+      nEvaluations = trie.solve(tester, matches);
+    } else {
+      stats.phase("solve");
+      nEvaluations = dictWords.size();
+
+      // Go through the dictionary's masks in one pass, many at a time
+
+      scanMasks(dictWords, tester, matches);
+    }
+
+    stats.phase("output");
+
+    for (auto i : matches) {
+      // the set of letters in this word
+      letterMask mask = dictWords.mask(i);
+
+      unsigned long wordScore = tester.scoreAndAccumulate(dictWords.length(i), mask);
 
-      if (tester.all(sortedDownLine))
-        std::cout << "* ";
+      if (tester.all(mask))
+        out << "* ";
       else
-        std::cout << "  ";
+        out << "  ";
 
-      std::cout << line << " " << wordScore << std::endl;
+      out << dictWords.word(i) << " " << wordScore << '\n';
 
     }
 
     // All done!
-    dictFile.close();
 
     if (result.count("total")) {
-      std::cout << "---------------" << std::endl;
-      std::cout << "Total score: " << tester.getTotalScore() << std::endl;
+      out << "---------------\n";
+      out << "Total score: " << tester.getTotalScore() << '\n';
+    }
+
+    out.flush();
+
+    if (result.count("stats")) {
+      stats.count("words read", dictWords.size());
+      stats.count("words rejected by nmin", dictWords.countShorter(nmin));
+      stats.count("predicate evaluations", nEvaluations);
+      stats.count("matches", matches.size());
+      stats.report(std::cerr);
     }
 
   } catch (const cxxopts::OptionException& e) {
@@ -0,0 +1,262 @@
+#include <iostream>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cxxopts.hpp"
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+#include "linereader.hpp"
+#include "output.hpp"
+#include "parallel.hpp"
+#include "query.hpp"
+
+// Where we are listening, to remove the socket when we're stopped
+static std::string socketPath;
+
+extern "C" void stopServer(int) {
+  unlink(socketPath.c_str());
+  _exit(0);
+}
+
+// Accepted connections waiting for a worker thread
+class connectionQueue {
+public:
+  void push(int fd) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      fds.push_back(fd);
+    }
+    ready.notify_one();
+  }
+
+  int pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this] { return !fds.empty(); });
+    int fd = fds.front();
+    fds.pop_front();
+    return fd;
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::deque<int> fds;
+};
+
+// Answer one request, followed by a blank line to end the response.
+// Returns false if the response couldn't all be sent.
+bool answer(queryEngine &engine, std::string_view request,
+            unsigned int nmin, outputWriter &out) {
+  const auto fields = splitFields(request);
+  const std::string_view command = fields.empty() ? "" : fields[0];
+
+  if (command == "SOLVE" || command == "SCORE") {
+    if (fields.size() < 2 || fields.size() > 3) {
+      out << "ERROR usage: " << command << " PUZZLE [NMIN]\n";
+    } else if (auto tester = parsePuzzle(fields[1],
+                                         fields.size() > 2 ? fields[2] : "",
+                                         nmin)) {
+      if (command == "SOLVE")
+        engine.writeSolution(out, *tester);
+      else
+        engine.writeScores(out, *tester);
+    } else {
+      out << "ERROR invalid puzzle\n";
+    }
+  } else if (command == "CHECK") {
+    if (fields.size() < 3 || fields.size() > 4) {
+      out << "ERROR usage: CHECK PUZZLE WORD [NMIN]\n";
+    } else if (auto tester = parsePuzzle(fields[1],
+                                         fields.size() > 3 ? fields[3] : "",
+                                         nmin)) {
+      if (const char *why = engine.reject(*tester, fields[2])) {
+        out << "NO " << why << '\n';
+      } else {
+        out << "OK " << tester->score(fields[2]);
+        if (tester->all(fields[2]))
+          out << " pangram";
+        out << '\n';
+      }
+    } else {
+      out << "ERROR invalid puzzle\n";
+    }
+  } else {
+    out << "ERROR unknown command\n";
+  }
+
+  out << '\n';
+  return out.flush();
+}
+
+// Requests must be shorter than this, not counting the newline
+const std::size_t maxRequestLength = 4096;
+
+// Answer a client's requests until it hangs up, reading from it or
+// writing to it fails or times out, or it sends a request that is too
+// long.  Once a response is cut short, the client can't tell where the
+// next one starts, so the connection is closed.
+void serve(int fd, queryEngine &engine, unsigned int nmin) {
+  lineReader in(fd, maxRequestLength);
+  in.setMaxLength(maxRequestLength);
+  outputWriter out(fd);
+  std::string_view request;
+
+  try {
+    while (in.next(request)) {
+      if (!answer(engine, request, nmin, out))
+        break;
+    }
+  } catch (const std::length_error&) {
+    out << "ERROR line too long\n\n";
+  } catch (const std::system_error&) {
+    // Nothing more to do for this client
+  }
+}
+
+int main(int argc, char* argv[]) {
+  try {
+
+    int nmin;
+    int nThreads;
+    int timeout;
+    std::string dict;
+    dictionary dictWords;
+
+    cxxopts::Options options(argv[0], "Server answering \"Spelling Bee\" queries over a Unix domain socket");
+
+    options.add_options()
+      ("d,dict", "Dictionary file path (text, or compiled by spbee-index)", cxxopts::value<std::string>(dict)
+       ->default_value("/usr/share/dict/words"), "FILE")
+      ("S,socket", "Path of the socket to listen on",
+       cxxopts::value<std::string>(socketPath)->default_value("spbee.sock"), "FILE")
+      ("n,nmin", "Default minimum word length", cxxopts::value<int>(nmin)
+       ->default_value("4"), "N")
+      ("j,jobs", "Number of worker threads, each serving one client"
+       " connection at a time (0 for one per CPU)",
+       cxxopts::value<int>(nThreads)->default_value("16"), "N")
+      ("t,timeout", "Hang up on a client that sends nothing (or reads"
+       " nothing) for this many seconds, freeing its worker (0 to wait"
+       " forever)", cxxopts::value<int>(timeout)->default_value("10"),
+       "SECONDS")
+      ("help", "Print this help message")
+      ;
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help({"", "Group"}) << std::endl;
+      std::cout << "Requests, one per line:\n"
+        "  SOLVE PUZZLE [NMIN]       the words solving the puzzle\n"
+        "  SCORE PUZZLE [NMIN]       the same with scores, and the total\n"
+        "  CHECK PUZZLE WORD [NMIN]  OK and the word's score, or NO and why\n"
+        "Each response ends with a blank line.  A request must be under "
+                << maxRequestLength << " bytes." << std::endl;
+      exit(0);
+    }
+
+    if (nmin < 0) {
+      std::cerr << "Invalid minimum word length: " << nmin << std::endl;
+      exit(1);
+    }
+
+    if (timeout < 0) {
+      std::cerr << "Invalid timeout: " << timeout << std::endl;
+      exit(1);
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+      std::cerr << "Invalid socket path '" << socketPath << "'" << std::endl;
+      exit(1);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // Load the dictionary and build the indexes before listening, so
+    // that clients can connect as soon as the socket exists
+
+    if (! dictWords.load(dict) ) {
+      std::cerr << "Can't read from dictionary file '"
+                << dict << "'" << std::endl;
+      exit(1);
+    };
+
+    queryEngine engine(dictWords);
+
+    // Replace the socket left behind by an earlier server, but nothing else
+    struct stat st;
+    if (lstat(socketPath.c_str(), &st) == 0) {
+      if (!S_ISSOCK(st.st_mode)) {
+        std::cerr << "'" << socketPath << "' exists and is not a socket"
+                  << std::endl;
+        exit(1);
+      }
+      unlink(socketPath.c_str());
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0
+        || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || listen(listener, SOMAXCONN) < 0) {
+      std::cerr << "Can't listen on '" << socketPath << "': "
+                << std::strerror(errno) << std::endl;
+      exit(1);
+    }
+
+    // A client hanging up mid-response shouldn't kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+
+    // A pool of workers, each serving one connection at a time
+
+    connectionQueue pending;
+    std::vector<std::thread> workers;
+
+    for (unsigned int t = 0; t < threadCount(nThreads); t++) {
+      workers.emplace_back([&] {
+          while (true) {
+            int fd = pending.pop();
+            serve(fd, engine, nmin);
+            close(fd);
+          }
+        });
+    }
+
+    while (true) {
+      int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd >= 0) {
+        // An idle client's reads (and a stalled one's writes) fail after
+        // the timeout, so no client can hold a worker forever
+        const timeval limit = {timeout, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof(limit));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+        pending.push(fd);
+      } else if (errno != EINTR && errno != ECONNABORTED) {
+        std::cerr << "Can't accept connections: " << std::strerror(errno)
+                  << std::endl;
+        unlink(socketPath.c_str());
+        exit(1);
+      }
+    }
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
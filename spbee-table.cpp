@@ -0,0 +1,190 @@
+#include <iostream>
+#include <fstream>
+
+#include <cctype>
+#include <algorithm>
+#include <optional>
+
+#include "cxxopts.hpp"
+
+#include "puzzle.hpp"
+#include "linereader.hpp"
+#include "output.hpp"
+#include "scoretable.hpp"
+
+// A word added to or removed from the dictionary
+struct wordChange {
+  letterMask mask;
+  std::size_t length;
+  int sign; // +1 for added, -1 for removed
+};
+
+// A new entry for the table, and the score it replaces
+struct tableUpdate {
+  std::size_t index;
+  std::uint32_t oldScore;
+  tableEntry entry;
+};
+
+int main(int argc, char* argv[]) {
+  try {
+
+    std::string tablePath;
+    std::string deltaPath;
+    scoreTable table;
+    outputWriter out;
+
+    cxxopts::Options options(argv[0], "Print or update a table of \"Spelling Bee\" puzzle scores saved by spbee-multi-scores --table");
+
+    options.add_options()
+      ("t,table", "Score table file path", cxxopts::value<std::string>(tablePath), "FILE")
+      ("delta", "Update the table in place for the words added (+word) and"
+       " removed (-word) in this file, one per line, and print the"
+       " puzzles whose scores changed",
+       cxxopts::value<std::string>(deltaPath), "FILE")
+      ("l,line-buffered", "Write out each line of output as soon as it is"
+       " ready (for interactive use)")
+      ("help", "Print this help message")
+      ;
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help({"", "Group"}) << std::endl;
+      exit(0);
+    }
+
+    if (!result.count("table")) {
+      std::cerr << "Need a table file (-t)" << std::endl;
+      exit(1);
+    }
+
+    out.setLineBuffered(result.count("line-buffered"));
+
+    const bool update = result.count("delta");
+
+    if (! table.open(tablePath, update) ) {
+      std::cerr << "Can't read score table file '"
+                << tablePath << "'" << std::endl;
+      exit(1);
+    };
+
+    if (!update) {
+      for (std::size_t i = 0; i < table.size(); i++) {
+        out << table[i].score << " "
+            << puzzleLetters(table[i].allMask, table[i].reqMask) << '\n';
+      }
+
+      out.flush();
+      return 0;
+    }
+
+    // Read the changed words.  Words that can never be in a puzzle
+    // don't change any scores, so they are left out.
+
+    lineReader deltaFile(deltaPath);
+    if (! deltaFile.good() ) {
+      std::cerr << "Can't read from delta file '"
+                << deltaPath << "'" << std::endl;
+      exit(1);
+    };
+
+    std::vector<wordChange> changes;
+    std::string_view line;
+
+    while (deltaFile.next(line)) {
+      if (line.empty())
+        continue;
+
+      if ((line[0] != '+' && line[0] != '-') || line.length() < 2) {
+        std::cerr << "Ignoring invalid delta line: " << line << std::endl;
+        continue;
+      }
+
+      std::string_view word = line.substr(1);
+      letterMask mask = toLetterMask(word);
+
+      if (word.length() >= table.nmin() && !(mask & nonLetterBit))
+        changes.push_back(wordChange{mask, word.length(),
+                                     line[0] == '+' ? 1 : -1});
+    }
+
+    // Work out the new scores of the puzzles whose letters cover a
+    // changed word, before touching the table, so a delta that doesn't
+    // fit the table leaves it as it was
+
+    std::vector<tableUpdate> updates;
+
+    for (std::size_t i = 0; i < table.size(); i++) {
+      const tableEntry &entry = table[i];
+      long score = entry.score;
+      long nWords = entry.nWords;
+      std::optional<puzzleTester> tester;
+
+      for (const auto& change : changes) {
+        if ((change.mask & entry.reqMask) != entry.reqMask
+            || (change.mask & ~entry.allMask))
+          continue;
+
+        if (!tester) {
+          tester.emplace(puzzleLetters(entry.allMask, entry.reqMask));
+          tester->nmin = table.nmin();
+        }
+
+        score += change.sign * long(tester->score(change.length, change.mask));
+        nWords += change.sign;
+      }
+
+      if (!tester)
+        continue;
+
+      if (score < 0 || nWords < 0) {
+        std::cerr << "Removing words from puzzle "
+                  << puzzleLetters(entry.allMask, entry.reqMask)
+                  << " that it can't have had; is this the right table?"
+                  << std::endl;
+        exit(1);
+      }
+
+      // Words that cancel out (say, one added and then removed) change
+      // nothing
+      if (score == entry.score && nWords == entry.nWords)
+        continue;
+
+      updates.push_back(tableUpdate{i, entry.score,
+                                    tableEntry{entry.allMask, entry.reqMask,
+                                               std::uint32_t(score),
+                                               std::uint32_t(nWords)}});
+    }
+
+    for (const auto& update : updates)
+      table[update.index] = update.entry;
+
+    if (! table.sync() ) {
+      std::cerr << "Can't write to score table file '"
+                << tablePath << "'" << std::endl;
+      exit(1);
+    };
+
+    // Only the puzzles whose scores changed
+    for (const auto& update : updates) {
+      if (update.entry.score == update.oldScore)
+        continue;
+
+      out << update.entry.score << " "
+          << puzzleLetters(update.entry.allMask, update.entry.reqMask)
+          << '\n';
+    }
+
+    out.flush();
+
+  } catch (const cxxopts::OptionException& e) {
+    std::cout << "error parsing options: " << e.what() << std::endl;
+    exit(1);
+  } catch (const std::system_error& e) {
+    std::cerr << "error reading input: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  return 0;
+}
@@ -7,13 +7,100 @@
 #include "cxxopts.hpp"
 
 #include "puzzle.hpp"
+#include "dictionary.hpp"
+#include "output.hpp"
+#include "stats.hpp"
+#include "subsets.hpp"
+#include "trie.hpp"
+#include "planner.hpp"
+#include "maskkernel.hpp"
+#include "puzzleset.hpp"
+#include "linereader.hpp"
+#include "query.hpp"
+
+// Append the ids of the words that solve any of the puzzles (and are at
+// least nmin long) to 'matches', by scanning the whole dictionary.
+// Returns the number of predicate evaluations.
+unsigned long scanAll(const dictionary &dictWords,
+                      const std::vector<puzzleTester> &testers,
+                      unsigned int nmin, std::vector<std::uint32_t> &matches) {
+  unsigned long nEvaluations = 0;
+
+  if (testers.size() < 16) {
+    // Scan the dictionary's masks for each puzzle, many words at a
+    // time (for a few puzzles, this beats one pass testing each word
+    // against them all)
+
+    for (const auto& tester : testers) {
+      scanMasks(dictWords, tester, matches);
+      nEvaluations += dictWords.size();
+    }
+  } else {
+    // Go through the dictionary in one pass, testing each word
+    // against all the puzzles at once
+
+    const puzzleSet puzzles(testers);
+
+    for (std::uint32_t i = 0; i < dictWords.size(); i++) {
+      if (dictWords.length(i) < nmin)
+        continue;
+
+      nEvaluations += testers.size();
+      if (puzzles.test(dictWords.mask(i)) & anyPass)
+        matches.push_back(i);
+    }
+  }
+
+  return nEvaluations;
+}
+
+// Solve each puzzle read from standard input, one per line as its
+// letters and optionally its nmin, writing a block for each: the line
+// as given, the puzzle's words, and a blank line.  Returns the number
+// of puzzles and the total number of words written.
+std::pair<std::size_t, std::size_t> solveBatch(queryEngine &engine,
+                                               unsigned int nmin,
+                                               outputWriter &out) {
+  lineReader in(STDIN_FILENO);
+  std::string_view line;
+  std::size_t nPuzzles = 0, nMatches = 0;
+
+  while (in.next(line)) {
+    const auto fields = splitFields(line);
+
+    // Every line gets a block, so the blocks match the input lines one
+    // for one; a blank or invalid line just gets an empty one
+    out << line << '\n';
+
+    if (!fields.empty()) {
+      auto tester = fields.size() <= 2
+        ? parsePuzzle(fields[0], fields.size() > 1 ? fields[1] : "", nmin)
+        : std::nullopt;
+
+      if (tester)
+        nMatches += engine.writeSolution(out, *tester);
+      else
+        std::cerr << "Ignoring invalid input: " << line << std::endl;
+
+      nPuzzles++;
+    }
+
+    out << '\n';
+  }
+
+  return {nPuzzles, nMatches};
+}
 
 int main(int argc, char* argv[]) {
+  runStats stats;
+
   try {
 
     int nmin;
     std::string dict;
-    std::ifstream dictFile;
+    std::string solver;
+    dictionary dictWords;
+    outputWriter out;
     std::vector<std::string> words;
     std::vector<puzzleTester> puzzleTesters;
 
@@ -23,10 +110,27 @@ int main(int argc, char* argv[]) {
       .show_positional_help();
 
     options.add_options()
-      ("d,dict", "Dictionary file path", cxxopts::value<std::string>(dict)
+      ("d,dict", "Dictionary file path (text, or compiled by spbee-index)", cxxopts::value<std::string>(dict)
        ->default_value("/usr/share/dict/words"), "FILE")
       ("n,nmin", "Minimum word length", cxxopts::value<int>(nmin)
        ->default_value("4"), "N")
+      ("s,solver", "Solving strategy: 'scan' the whole dictionary,"
+       " look up the 'subsets' of the puzzle letters, walk a"
+       " 'trie' of the words along the puzzle letters, or let the"
+       " planner pick for each puzzle ('auto')",
+       cxxopts::value<std::string>(solver)->default_value("scan"), "NAME")
+      ("b,batch", "Read puzzles from standard input instead, one per line"
+       " (the letters, then optionally an nmin for just that puzzle), and"
+       " write a separate block of words for each, ending with a blank"
+       " line.  The solver is picked for each puzzle as with -s auto.")
+      ("v,verbose", "With --solver auto, report the strategy chosen for"
+       " each puzzle, and its estimated cost, on stderr")
+      ("l,line-buffered", "Write out each line of output as soon as it is"
+       " ready (for interactive use)")
+      ("stats", "Report time spent and work done on stderr")
+      ("perf", "Report what --stats does, plus hardware performance"
+       " counters (cycles, instructions, branch and cache misses) for each"
+       " phase")
       ("help", "Print this help message")
       ("positional",
        "puzzle letter strings: For each puzzle, give a string"
@@ -47,10 +151,30 @@ int main(int argc, char* argv[]) {
       exit(0);
     }
 
-    if (!result.count("positional")) { // no input, nothing to do.
+    out.setLineBuffered(result.count("line-buffered"));
+
+    if (result.count("perf"))
+      stats.enablePerf();
+
+    if (nmin < 0) {
+      std::cerr << "Invalid minimum word length: " << nmin << std::endl;
+      exit(1);
+    }
+
+    const bool batch = result.count("batch");
+
+    if (batch && result.count("positional")) {
+      std::cerr << "With --batch, puzzles are read from standard input"
+                << std::endl;
+      exit(1);
+    }
+
+    if (!result.count("positional") && !batch) { // no input, nothing to do.
       exit(0);
     }
 
+    stats.phase("puzzles");
+
     // Validate input words
     for (const auto& word : words) {
       if (validInput(word))
@@ -59,7 +183,7 @@ int main(int argc, char* argv[]) {
         std::cerr << "Ignoring invalid input: " << word << std::endl;
     }
 
-    if (!puzzleTesters.size()) { // no valid input
+    if (!puzzleTesters.size() && !batch) { // no valid input
       std::cerr << "No valid inputs" << std::endl;
       exit(1);
     }
@@ -69,47 +193,126 @@ int main(int argc, char* argv[]) {
       puzzleTester.nmin = nmin;
     }
     
-    // Open dictionary file
+    if (solver != "scan" && solver != "subsets" && solver != "trie"
+        && solver != "auto") {
+      std::cerr << "Unknown solver: " << solver << std::endl;
+      exit(1);
+    }
+
+    stats.phase("dictionary");
 
-    dictFile.open(dict);
-    if (! dictFile.good() ) {
+    // Load dictionary file (text or compiled index)
+
+    if (! dictWords.load(dict) ) {
       std::cerr << "Can't read from dictionary file '"
                 << dict << "'" << std::endl;
       exit(1);
     };
 
-    // Go through the dictionary file in one pass
+    if (batch) {
+      // Build every index once, for all the puzzles to come
+      stats.phase("index");
+      queryEngine engine(dictWords);
 
-    std::string line;
+      stats.phase("solve");
+      auto counts = solveBatch(engine, nmin, out);
+      out.flush();
 
-    while (std::getline(dictFile, line)) {
-      std::string sortedDownLine = line;
+      if (result.count("stats") || result.count("perf")) {
+        stats.count("words read", dictWords.size());
+        stats.count("puzzles", counts.first);
+        stats.count("matches", counts.second);
+        stats.report(std::cerr, "solve");
+      }
 
-      if (line.length() < nmin)
-        continue;
+      return 0;
+    }
+
+    // Find the ids of all the words that solve any of the puzzles
+
+    std::vector<std::uint32_t> matches;
+    unsigned long nEvaluations = 0;
+
+    // All the puzzles' masks, side by side
+    const puzzleSet puzzles(puzzleTesters);
 
-      // downcase, sort, and remove dups
-      downSortUniq(sortedDownLine);
+    if (solver == "subsets") {
+      stats.phase("index");
+      subsetIndex index(dictWords);
 
-      if (std::any_of(puzzleTesters.begin(), puzzleTesters.end(),
-                      [&](const puzzleTester & t){ return t(sortedDownLine); })) {
+      stats.phase("solve");
+      for (const auto& puzzleTester : puzzleTesters) {
+        nEvaluations += index.solve(puzzleTester, matches);
+      }
+    } else if (solver == "trie") {
+      stats.phase("index");
+      wordTrie trie(dictWords);
+
+      stats.phase("solve");
+      for (const auto& puzzleTester : puzzleTesters) {
+        nEvaluations += trie.solve(puzzleTester, matches);
+      }
+    } else if (solver == "auto") {
+      // Any indexes are built as part of solving
+      stats.phase("solve");
+      queryPlanner planner(dictWords, puzzleTesters.size());
+
+      // The puzzles planned as scans are all solved together at the
+      // end, so that many of them still take just one pass
+      std::vector<puzzleTester> scanned;
 
-        if (std::any_of(puzzleTesters.begin(), puzzleTesters.end(),
-                        [&](const puzzleTester & t){
-                          return t.all(sortedDownLine); })) {
-          std::cout << "* ";
-        } else { std::cout << "  "; };
+      for (const auto& puzzleTester : puzzleTesters) {
+        if (result.count("verbose"))
+          planner.explain(std::cerr, puzzleTester);
 
-        std::cout << line << std::endl;
+        const solveStrategy strategy = planner.choose(puzzleTester);
+        if (strategy == solveStrategy::scan)
+          scanned.push_back(puzzleTester);
+        else
+          nEvaluations += planner.solve(puzzleTester, strategy, matches);
       }
+
+      nEvaluations += scanAll(dictWords, scanned, nmin, matches);
+    } else {
+      stats.phase("solve");
+      nEvaluations += scanAll(dictWords, puzzleTesters, nmin, matches);
+    }
+
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()),
+                  matches.end());
+
+    stats.phase("output");
+
+    for (auto i : matches) {
+      // the set of letters in this word
+      letterMask mask = dictWords.mask(i);
+
+      if (puzzles.test(mask) & anyPangram) {
+        out << "* ";
+      } else { out << "  "; };
+
+      out << dictWords.word(i) << '\n';
     }
 
     // All done!
-    dictFile.close();
+
+    out.flush();
+
+    if (result.count("stats") || result.count("perf")) {
+      stats.count("words read", dictWords.size());
+      stats.count("words rejected by nmin", dictWords.countShorter(nmin));
+      stats.count("predicate evaluations", nEvaluations);
+      stats.count("matches", matches.size());
+      stats.report(std::cerr, "solve");
+    }
 
   } catch (const cxxopts::OptionException& e) {
     std::cout << "error parsing options: " << e.what() << std::endl;
     exit(1);
+  } catch (const std::system_error& e) {
+    std::cerr << "error reading input: " << e.what() << std::endl;
+    exit(1);
   }
 
   return 0;
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "perfcounters.hpp"
+
+// Where a run's time goes: the wall-clock and CPU time of each phase,
+// plus counts of the work done, reported when the user asks for --stats.
+// Timing starts when the runStats is made, in a phase called "options".
+// Hardware event counts for each phase can be added with enablePerf().
+class runStats {
+public:
+  runStats() :
+    phaseName("options"), wallStart(clock::now()), cpuStart(std::clock()) {
+  }
+
+  // Also count hardware events, starting with the current phase
+  void enablePerf() {
+    perf.reset(new perfCounters);
+    perfStart = perf->read();
+  }
+
+  // End the current phase, and start one called 'name'
+  void phase(const std::string &name) {
+    const auto wallNow = clock::now();
+    const std::clock_t cpuNow = std::clock();
+
+    phases.push_back(phaseTimes{
+        phaseName,
+        std::chrono::duration<double>(wallNow - wallStart).count(),
+        double(cpuNow - cpuStart) / CLOCKS_PER_SEC,
+        {}});
+
+    if (perf) {
+      auto perfNow = perf->read();
+      for (std::size_t e = 0; e < perfNow.size(); e++)
+        phases.back().events.push_back(perfNow[e] - perfStart[e]);
+      perfStart = perfNow;
+    }
+
+    phaseName = name;
+    wallStart = wallNow;
+    cpuStart = cpuNow;
+  }
+
+  // Add n to the counter called 'name'
+  void count(const std::string &name, unsigned long n) {
+    for (auto& counter : counters) {
+      if (counter.first == name) {
+        counter.second += n;
+        return;
+      }
+    }
+
+    counters.emplace_back(name, n);
+  }
+
+  // End the last phase, and write out all the times and counters.  If
+  // hardware events were counted, the events of 'hotPhase' are also
+  // given per "predicate evaluations" counted.
+  void report(std::ostream &os, const std::string &hotPhase = "") {
+    phase("");
+
+    double wallTotal = 0, cpuTotal = 0;
+
+    os << std::fixed << std::setprecision(3)
+       << std::left << std::setw(24) << "phase"
+       << std::right << std::setw(12) << "wall ms"
+       << std::setw(12) << "cpu ms" << '\n';
+
+    for (const auto& p : phases) {
+      os << std::left << std::setw(24) << p.name
+         << std::right << std::setw(12) << 1e3 * p.wall
+         << std::setw(12) << 1e3 * p.cpu << '\n';
+      wallTotal += p.wall;
+      cpuTotal += p.cpu;
+    }
+
+    os << std::left << std::setw(24) << "total"
+       << std::right << std::setw(12) << 1e3 * wallTotal
+       << std::setw(12) << 1e3 * cpuTotal << '\n';
+
+    for (const auto& counter : counters) {
+      os << std::left << std::setw(24) << counter.first
+         << std::right << std::setw(24) << counter.second << '\n';
+    }
+
+    if (perf)
+      reportPerf(os, hotPhase);
+
+    os.flush();
+  }
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  struct phaseTimes {
+    std::string name;
+    double wall; // seconds
+    double cpu;  // seconds, summed over all threads
+    std::vector<std::uint64_t> events; // hardware events, if counted
+  };
+
+  void reportPerf(std::ostream &os, const std::string &hotPhase) {
+    if (!perf->anyAvailable()) {
+      os << "hardware counters unavailable\n";
+      return;
+    }
+
+    os << std::left << std::setw(24) << "phase" << std::right;
+    for (std::size_t e = 0; e < perfCounters::nEvents; e++)
+      os << std::setw(16) << perfCounters::eventName(e);
+    os << '\n';
+
+    for (const auto& p : phases) {
+      if (p.events.empty())
+        continue;
+
+      os << std::left << std::setw(24) << p.name << std::right;
+      for (std::size_t e = 0; e < perfCounters::nEvents; e++) {
+        if (perf->available(e))
+          os << std::setw(16) << p.events[e];
+        else
+          os << std::setw(16) << "-";
+      }
+      os << '\n';
+    }
+
+    unsigned long nEvaluations = 0;
+    for (const auto& counter : counters)
+      if (counter.first == "predicate evaluations")
+        nEvaluations = counter.second;
+
+    for (const auto& p : phases) {
+      if (p.name != hotPhase || p.events.empty() || !nEvaluations)
+        continue;
+
+      os << std::left << std::setw(24) << (p.name + " per eval")
+         << std::right << std::setprecision(4);
+      for (std::size_t e = 0; e < perfCounters::nEvents; e++) {
+        if (perf->available(e))
+          os << std::setw(16) << double(p.events[e]) / nEvaluations;
+        else
+          os << std::setw(16) << "-";
+      }
+      os << '\n';
+    }
+  }
+
+  std::vector<phaseTimes> phases;
+  std::vector<std::pair<std::string, unsigned long>> counters;
+
+  // The phase in progress
+  std::string phaseName;
+  clock::time_point wallStart;
+  std::clock_t cpuStart;
+
+  // Hardware events, if they are being counted
+  std::unique_ptr<perfCounters> perf;
+  std::vector<std::uint64_t> perfStart;
+};
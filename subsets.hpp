@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+
+// An index from letter sets to the dictionary words spelled with
+// exactly those letters.  A puzzle with n letters, r of them required,
+// is solved by looking up each of the 2^(n-r) subsets of its letters
+// that contain all the required ones, rather than scanning every word.
+class subsetIndex {
+public:
+  explicit subsetIndex(const dictionary &dictWords) : dictWords(dictWords) {
+    // Sort the word ids by letter set, keeping dictionary order within
+    // each set, so each set's words are one contiguous range
+    for (std::uint32_t i = 0; i < dictWords.size(); i++) {
+      if (!(dictWords.mask(i) & nonLetterBit))
+        ids.push_back(i);
+    }
+
+    std::stable_sort(ids.begin(), ids.end(),
+                     [&](std::uint32_t a, std::uint32_t b) {
+                       return dictWords.mask(a) < dictWords.mask(b);
+                     });
+
+    for (std::uint32_t begin = 0, end; begin < ids.size(); begin = end) {
+      letterMask mask = dictWords.mask(ids[begin]);
+      for (end = begin + 1;
+           end < ids.size() && dictWords.mask(ids[end]) == mask;
+           end++)
+        ;
+      ranges[mask] = std::make_pair(begin, end);
+    }
+  }
+
+  // Append the ids of the words that solve the puzzle (and are at least
+  // tester.nmin long) to 'matches', in dictionary order.  Returns the
+  // number of letter sets looked up.
+  std::size_t solve(const puzzleTester &tester,
+                    std::vector<std::uint32_t> &matches) const {
+    const letterMask req = tester.getReqMask();
+    const letterMask optional = tester.getAllMask() & ~req;
+    const std::size_t first = matches.size();
+    std::size_t nLookups = 0;
+
+    // Visit every subset of the optional letters, down to the empty set
+    for (letterMask sub = optional; ; sub = (sub - 1) & optional) {
+      auto range = ranges.find(sub | req);
+      nLookups++;
+
+      if (range != ranges.end()) {
+        for (auto i = range->second.first; i < range->second.second; i++) {
+          if (dictWords.length(ids[i]) >= tester.nmin)
+            matches.push_back(ids[i]);
+        }
+      }
+
+      if (!sub)
+        break;
+    }
+
+    std::sort(matches.begin() + first, matches.end());
+
+    return nLookups;
+  }
+
+private:
+  const dictionary &dictWords;
+
+  // Word ids, grouped by letter set
+  std::vector<std::uint32_t> ids;
+
+  // For each letter set, its [begin, end) range in ids
+  std::unordered_map<letterMask, std::pair<std::uint32_t, std::uint32_t>> ranges;
+};
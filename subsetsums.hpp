@@ -0,0 +1,78 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "puzzle.hpp"
+#include "wordgroups.hpp"
+
+// Scores every choice of required letter for a set of puzzle letters
+// at once.  For a set of k letters, the 2^k subsets are numbered by
+// which of the letters they contain; the words spelled with exactly
+// each subset are looked up, and a sum-over-subsets (zeta transform)
+// pass then gives, for every subset, the total score of the words that
+// fit inside it.  The words that use letter j are exactly those that
+// fit in the whole set but not in the set without j.
+class subsetSumScorer {
+public:
+  // The largest letter set we will score; the tables have 2^k entries
+  static const unsigned int maxLetters = 16;
+
+  subsetSumScorer(const std::vector<wordGroup> &groups) {
+    byMask.reserve(groups.size());
+    for (const auto& group : groups)
+      byMask[group.mask] = &group;
+  }
+
+  // Put the score of the puzzle with the letters in 'set', where the
+  // j-th of them (in alphabetical order) is required, into scores[j].
+  // The set may have at most maxLetters letters.  The groups must have
+  // been made with the nmin that is wanted for scoring.
+  void scoreCenters(letterMask set, std::vector<unsigned int> &scores) {
+    std::vector<letterMask> bits;
+    for (char c = 'a'; c <= 'z'; c++) {
+      if (set & charMask(c))
+        bits.push_back(charMask(c));
+    }
+
+    const unsigned int k = bits.size();
+    const std::size_t full = (std::size_t(1) << k) - 1;
+
+    // Look up the words with exactly each subset of the letters
+    masks.assign(full + 1, 0);
+    sums.assign(full + 1, 0);
+    unsigned int nPangrams = 0;
+
+    for (std::size_t s = 0; s <= full; s++) {
+      // s's letters are those of s without its lowest bit, plus that one
+      if (s)
+        masks[s] = masks[s & (s - 1)] | bits[__builtin_ctzl(s)];
+
+      auto group = byMask.find(masks[s]);
+      if (group != byMask.end()) {
+        sums[s] = group->second->baseScore;
+        if (s == full)
+          nPangrams = group->second->nWords;
+      }
+    }
+
+    // Sum over subsets, one letter at a time
+    for (unsigned int j = 0; j < k; j++) {
+      const std::size_t bit = std::size_t(1) << j;
+      for (std::size_t s = 0; s <= full; s++)
+        if (s & bit)
+          sums[s] += sums[s ^ bit];
+    }
+
+    scores.resize(k);
+    for (unsigned int j = 0; j < k; j++) {
+      scores[j] = sums[full] - sums[full ^ (std::size_t(1) << j)]
+        + nPangrams * k;
+    }
+  }
+
+private:
+  std::unordered_map<letterMask, const wordGroup*> byMask;
+  std::vector<letterMask> masks;
+  std::vector<unsigned int> sums;
+};
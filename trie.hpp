@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+
+// The dictionary's words as a trie over their (downcased) letters.  A
+// puzzle is solved by a depth-first walk that only follows the edges
+// for the puzzle's letters, so every word containing any other letter
+// is skipped a whole subtree at a time; the required letters are
+// checked at the ends of words, and a subtree is skipped as soon as no
+// word in it can have the required letters still missing.  This pays
+// off when the puzzle has many letters, where there are too many
+// subsets to look up one by one.
+//
+// The trie is path compressed: a chain of nodes that each have just one
+// child and no words of their own is merged into its last node, whose
+// edge is then labelled with all the chain's letters.  The walk checks
+// a whole label at once, from the set of letters in it.
+//
+// The nodes are stored in breadth-first order so that each node's
+// children are contiguous: the child whose label starts with letter c
+// is at firstChild + (the number of children for letters before c).
+// Everything the walk needs from a node is in one 24-byte trieNode.
+class wordTrie {
+  struct trieNode {
+    letterMask children;      // the first letters of the children's labels
+    letterMask below;         // the letters anywhere below the node
+    letterMask label;         // the letters on the edge into the node
+    std::uint32_t depth;      // the length of the node's path
+    std::uint32_t firstChild; // where the children start
+    std::uint32_t firstWord;  // where the node's words start in wordIds
+  };
+
+public:
+  explicit wordTrie(const dictionary &dictWords) {
+    // Sort the ids of the words that are all letters by their downcased
+    // spelling, keeping dictionary order among words spelled alike
+    std::vector<std::uint32_t> ids;
+    for (std::uint32_t i = 0; i < dictWords.size(); i++) {
+      if (!(dictWords.mask(i) & nonLetterBit))
+        ids.push_back(i);
+    }
+
+    std::stable_sort(ids.begin(), ids.end(),
+                     [&](std::uint32_t a, std::uint32_t b) {
+                       return foldedLess(dictWords.word(a), dictWords.word(b));
+                     });
+
+    // Build the nodes a level at a time.  Each node covers the range of
+    // ids whose first 'depth' letters spell its path; the words that
+    // end there come first in the range.
+    std::deque<std::tuple<std::size_t, std::size_t, std::size_t>> pending;
+    addNode();
+    pending.emplace_back(0, ids.size(), 0);
+
+    for (std::uint32_t node = 0; !pending.empty(); node++) {
+      std::size_t begin, end, depth;
+      std::tie(begin, end, depth) = pending.front();
+      pending.pop_front();
+
+      // Extend the edge into the node for as long as no word ends and
+      // all the words go on with the same letter.  The ids are sorted,
+      // so the first and last words agree only if they all do.
+      if (node > 0) {
+        while (dictWords.length(ids[begin]) > depth
+               && charMask(dictWords.word(ids[begin])[depth])
+               == charMask(dictWords.word(ids[end - 1])[depth])) {
+          nodes[node].label |= charMask(dictWords.word(ids[begin])[depth]);
+          depth++;
+        }
+      }
+      nodes[node].depth = depth;
+
+      nodes[node].firstWord = wordIds.size();
+      while (begin < end && dictWords.length(ids[begin]) == depth)
+        wordIds.push_back(ids[begin++]);
+
+      nodes[node].firstChild = nodes.size();
+      while (begin < end) {
+        const letterMask letter = charMask(dictWords.word(ids[begin])[depth]);
+        std::size_t last = begin + 1;
+        while (last < end && charMask(dictWords.word(ids[last])[depth]) == letter)
+          last++;
+
+        nodes[node].children |= letter;
+        addNode(letter);
+        pending.emplace_back(begin, last, depth + 1);
+        begin = last;
+      }
+    }
+
+    // An end marker, for the words of the last node
+    nodes.push_back(trieNode{0, 0, 0, 0, 0, std::uint32_t(wordIds.size())});
+
+    // Children come after their parents, so one backwards pass gathers
+    // the letters below each node
+    for (std::size_t node = nodes.size() - 1; node-- > 0; ) {
+      letterMask children = nodes[node].children;
+      std::uint32_t child = nodes[node].firstChild;
+      for (; children; children &= children - 1, child++)
+        nodes[node].below |= nodes[child].label | nodes[child].below;
+    }
+  }
+
+  // Append the ids of the words that solve the puzzle (and are at least
+  // tester.nmin long) to 'matches', in dictionary order.  Returns the
+  // number of trie nodes visited.
+  std::size_t solve(const puzzleTester &tester,
+                    std::vector<std::uint32_t> &matches) const {
+    const letterMask all = tester.getAllMask();
+    const letterMask req = tester.getReqMask();
+    const std::size_t first = matches.size();
+    std::size_t nVisited = 0;
+
+    // Nodes still to visit, with the letters on their path
+    struct visit {
+      std::uint32_t node;
+      letterMask path;
+    };
+    std::vector<visit> stack{visit{0, 0}};
+
+    while (!stack.empty()) {
+      const visit v = stack.back();
+      stack.pop_back();
+      nVisited++;
+
+      const trieNode &node = nodes[v.node];
+
+      if (node.depth >= tester.nmin && (v.path & req) == req) {
+        matches.insert(matches.end(),
+                       wordIds.begin() + node.firstWord,
+                       wordIds.begin() + nodes[v.node + 1].firstWord);
+      }
+
+      // Follow only the edges spelled with the puzzle's letters, into
+      // subtrees that can still supply the missing required letters
+      for (letterMask next = node.children & all; next; next &= next - 1) {
+        const letterMask letter = next & -next;
+        const std::uint32_t child = node.firstChild
+          + __builtin_popcount(node.children & (letter - 1));
+        const letterMask path = v.path | nodes[child].label;
+        if ((path & ~all) || ((path | nodes[child].below) & req) != req)
+          continue;
+        stack.push_back(visit{child, path});
+      }
+    }
+
+    std::sort(matches.begin() + first, matches.end());
+
+    return nVisited;
+  }
+
+  // The number of nodes
+  std::size_t size() const {
+    return nodes.size() - 1;
+  }
+
+private:
+  // Whether word a comes before word b, ignoring case
+  static bool foldedLess(std::string_view a, std::string_view b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+                                        [](char x, char y) {
+                                          return tolower(x) < tolower(y);
+                                        });
+  }
+
+  // Add a node whose edge starts with the letter
+  void addNode(letterMask letter = 0) {
+    nodes.push_back(trieNode{0, 0, letter, 0, 0, 0});
+  }
+
+  std::vector<trieNode> nodes;
+  std::vector<std::uint32_t> wordIds; // the words ending at each node
+};
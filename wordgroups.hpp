@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "puzzle.hpp"
+#include "dictionary.hpp"
+
+// Collapse a dictionary into one wordGroup per distinct letter set,
+// ordered by mask.  Words shorter than nmin, and words with characters
+// other than letters, can never score, so they are left out.
+std::vector<wordGroup> groupByMask(const dictionary &dictWords,
+                                   unsigned int nmin) {
+  std::vector<std::pair<letterMask, unsigned int>> scored;
+  scored.reserve(dictWords.size());
+
+  for (std::size_t i = 0; i < dictWords.size(); i++) {
+    if (dictWords.length(i) < nmin || (dictWords.mask(i) & nonLetterBit))
+      continue;
+
+    scored.emplace_back(dictWords.mask(i),
+                        lengthScore(dictWords.length(i), nmin));
+  }
+
+  std::sort(scored.begin(), scored.end());
+
+  std::vector<wordGroup> groups;
+
+  for (const auto& word : scored) {
+    if (groups.empty() || groups.back().mask != word.first)
+      groups.push_back(wordGroup{word.first, 0, 0});
+
+    groups.back().nWords += 1;
+    groups.back().baseScore += word.second;
+  }
+
+  return groups;
+}